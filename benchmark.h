@@ -0,0 +1,334 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct CameraKeyframe
+{
+	float time; // seconds
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+	int debugFlags = 0; // ShaderFeature bits, held until the next keyframe
+};
+
+// scripted camera flight, linearly interpolated between keyframes
+class CameraPath
+{
+private:
+	std::vector<CameraKeyframe> keyframes;
+
+public:
+	// ~60s flight at CAMERA_SPEED_DEFAULT over ridges, a turn and a climb
+	static CameraPath defaultPath()
+	{
+		CameraPath path;
+		path.keyframes = {
+			{0.0f, glm::vec3(0.0f, 40.0f, 0.0f), -90.0f, -20.0f},
+			{20.0f, glm::vec3(0.0f, 40.0f, -300.0f), -90.0f, -20.0f},
+			{30.0f, glm::vec3(150.0f, 50.0f, -400.0f), 0.0f, -25.0f},
+			{45.0f, glm::vec3(375.0f, 80.0f, -400.0f), 0.0f, -35.0f},
+			{60.0f, glm::vec3(375.0f, 40.0f, -175.0f), 90.0f, -15.0f},
+		};
+		return path;
+	}
+
+	// one keyframe per line: time x y z yaw pitch, # starts a comment
+	bool load(const std::string &filePath)
+	{
+		std::ifstream file(filePath);
+		if (!file)
+		{
+			std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESFULLY_READ: " << filePath << std::endl;
+			return false;
+		}
+
+		clear();
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream fields(line);
+			CameraKeyframe keyframe;
+			if (fields >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch)
+				keyframes.push_back(keyframe);
+		}
+
+		std::sort(keyframes.begin(), keyframes.end(), [](const CameraKeyframe &a, const CameraKeyframe &b) { return a.time < b.time; });
+		return !keyframes.empty();
+	}
+
+	void clear()
+	{
+		keyframes.clear();
+	}
+
+	// keyframes must be added in time order
+	void add(const CameraKeyframe &keyframe)
+	{
+		keyframes.push_back(keyframe);
+	}
+
+	float duration() const
+	{
+		return keyframes.empty() ? 0.0f : keyframes.back().time;
+	}
+
+	// clamps outside the path
+	CameraKeyframe sample(float time) const
+	{
+		if (keyframes.empty())
+			return {time, glm::vec3(0.0f), -90.0f, 0.0f, 0};
+
+		if (time <= keyframes.front().time)
+			return keyframes.front();
+
+		for (size_t i = 1; i < keyframes.size(); i++)
+		{
+			const CameraKeyframe &a = keyframes[i - 1];
+			const CameraKeyframe &b = keyframes[i];
+			if (time <= b.time)
+			{
+				float t = (time - a.time) / (b.time - a.time);
+				return {time, a.position + (b.position - a.position) * t, a.yaw + (b.yaw - a.yaw) * t, a.pitch + (b.pitch - a.pitch) * t, a.debugFlags};
+			}
+		}
+
+		return keyframes.back();
+	}
+};
+
+// --stress flight shapes
+enum StressPattern
+{
+	STRESS_STRAIGHT,
+	STRESS_SPIRAL,
+	STRESS_RANDOM,
+	STRESS_PATTERN_COUNT
+};
+
+const char *const STRESS_PATTERN_NAMES[STRESS_PATTERN_COUNT] = {"straight", "spiral", "random"};
+
+// units per second, from CAMERA_SPEED_DEFAULT well past CAMERA_SPEED_FAST
+const std::vector<float> STRESS_SPEEDS_DEFAULT = {15.0f, 60.0f, 150.0f, 400.0f, 1000.0f};
+
+// above the highest ridges, looking down far enough to keep the terrain in view
+const float STRESS_ALTITUDE = 80.0f;
+const float STRESS_PITCH = -30.0f;
+
+// constant speed flight with one keyframe per timestep. the random turns come from
+// a fixed seed LCG, so every build and every platform flies exactly the same path
+inline CameraPath stressPath(StressPattern pattern, float speed, float duration, float timestep)
+{
+	CameraPath path;
+
+	glm::vec3 position(0.0f, STRESS_ALTITUDE, 0.0f);
+	float yaw = -45.0f;
+
+	float radius = 100.0f; // spiral, widens by 20 units per second
+	float angle = 0.0f;
+
+	unsigned int seed = 1234567u; // random
+	float turnRate = 0.0f; // degrees per second
+
+	if (pattern == STRESS_SPIRAL)
+	{
+		position.x = radius;
+		yaw = 90.0f;
+	}
+
+	for (float time = 0.0f; time <= duration; time += timestep)
+	{
+		path.add({time, position, yaw, STRESS_PITCH, 0});
+
+		if (pattern == STRESS_SPIRAL)
+		{
+			angle += speed * timestep / radius;
+			radius += 20.0f * timestep;
+			position.x = radius * std::cos(angle);
+			position.z = radius * std::sin(angle);
+			yaw = glm::degrees(angle) + 90.0f;
+			continue;
+		}
+
+		// a new turn rate in -120...120 every half second
+		if (pattern == STRESS_RANDOM)
+		{
+			if ((int)((time + timestep) * 2.0f) != (int)(time * 2.0f))
+			{
+				seed = seed * 1664525u + 1013904223u;
+				turnRate = ((seed >> 8) / 16777216.0f * 2.0f - 1.0f) * 120.0f;
+			}
+			yaw += turnRate * timestep;
+		}
+
+		position.x += std::cos(glm::radians(yaw)) * speed * timestep;
+		position.z += std::sin(glm::radians(yaw)) * speed * timestep;
+	}
+
+	return path;
+}
+
+// flat name -> value JSON written by every benchmark. settings like the hitch
+// budget are kept apart from the metrics so benchstore never scores them
+class BenchmarkResults
+{
+private:
+	std::string name;
+	std::vector<std::pair<std::string, double>> metrics;
+	std::vector<std::pair<std::string, double>> settings;
+
+public:
+	BenchmarkResults(const std::string &name) : name(name) {}
+
+	void add(const std::string &metric, double value)
+	{
+		metrics.push_back({metric, value});
+	}
+
+	void setting(const std::string &setting, double value)
+	{
+		settings.push_back({setting, value});
+	}
+
+	bool write(const std::string &filePath) const
+	{
+		std::ofstream file(filePath);
+		if (!file)
+		{
+			std::cout << "ERROR::BENCHMARK::CANNOT_WRITE: " << filePath << std::endl;
+			return false;
+		}
+
+		file.precision(10);
+		file << "{\n\t\"benchmark\": \"" << name << "\",\n\t\"metrics\": {";
+		for (size_t i = 0; i < metrics.size(); i++)
+			file << (i ? ",\n" : "\n") << "\t\t\"" << metrics[i].first << "\": " << metrics[i].second;
+		file << "\n\t}";
+		if (!settings.empty())
+		{
+			file << ",\n\t\"settings\": {";
+			for (size_t i = 0; i < settings.size(); i++)
+				file << (i ? ",\n" : "\n") << "\t\t\"" << settings[i].first << "\": " << settings[i].second;
+			file << "\n\t}";
+		}
+		file << "\n}\n";
+		return true;
+	}
+};
+
+// one benchmark frame, placed by how far along the camera path it was drawn
+struct PathTiming
+{
+	int frame;
+	float time; // seconds into the path
+	float distance; // units flown since the start
+	glm::vec3 position;
+	double milliseconds;
+};
+
+inline bool writeTimings(const std::string &filePath, const std::vector<PathTiming> &timings)
+{
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cout << "ERROR::BENCHMARK::CANNOT_WRITE: " << filePath << std::endl;
+		return false;
+	}
+
+	file << "frame,time,distance,x,y,z,frame_ms\n";
+	for (const PathTiming &timing : timings)
+	{
+		file << timing.frame << "," << timing.time << "," << timing.distance << ","
+			 << timing.position.x << "," << timing.position.y << "," << timing.position.z << ","
+			 << timing.milliseconds << "\n";
+	}
+
+	return true;
+}
+
+// frame times of one run and their summary
+class FrameStats
+{
+private:
+	std::vector<double> frameTimes; // milliseconds
+
+public:
+	void add(double milliseconds)
+	{
+		frameTimes.push_back(milliseconds);
+	}
+
+	size_t count() const
+	{
+		return frameTimes.size();
+	}
+
+	double mean() const
+	{
+		if (frameTimes.empty())
+			return 0.0;
+
+		double sum = 0.0;
+		for (double time : frameTimes)
+			sum += time;
+		return sum / frameTimes.size();
+	}
+
+	// nearest rank, p in 0...100
+	double percentile(double p) const
+	{
+		if (frameTimes.empty())
+			return 0.0;
+
+		std::vector<double> sorted = frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+
+		size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+		rank = std::min(std::max(rank, (size_t)1), sorted.size());
+		return sorted[rank - 1];
+	}
+
+	double max() const
+	{
+		return frameTimes.empty() ? 0.0 : *std::max_element(frameTimes.begin(), frameTimes.end());
+	}
+
+	// frames over budget milliseconds
+	int hitches(double budget) const
+	{
+		return (int)std::count_if(frameTimes.begin(), frameTimes.end(), [&](double time) { return time > budget; });
+	}
+
+	void print(const std::string &name) const
+	{
+		std::cout << name << ": " << count() << " frames, frame ms"
+				  << " mean " << mean()
+				  << " p50 " << percentile(50)
+				  << " p95 " << percentile(95)
+				  << " p99 " << percentile(99)
+				  << " max " << max() << std::endl;
+	}
+
+	void addMetrics(BenchmarkResults &results, const std::string &prefix) const
+	{
+		results.add(prefix + "frames", count());
+		results.add(prefix + "frame_ms_mean", mean());
+		results.add(prefix + "frame_ms_p50", percentile(50));
+		results.add(prefix + "frame_ms_p95", percentile(95));
+		results.add(prefix + "frame_ms_p99", percentile(99));
+		results.add(prefix + "frame_ms_max", max());
+	}
+};
+
+#endif
@@ -0,0 +1,408 @@
+// stores benchmark results (the BenchmarkResults JSON of glterrain, noisebench and
+// meshbench) per commit and compares a candidate commit against a baseline:
+//   g++ -std=c++17 -O2 benchstore.cpp -o benchstore
+//
+//   for i in 1 2 3 4 5; do ./noisebench --quick --results run.json; ./benchstore add $(git rev-parse --short HEAD) run.json; done
+//   ./benchstore compare <baseline> <candidate> [--thresholds benchthresholds.txt]
+//
+// compare exits with 1 if any metric got worse by more than its threshold and the
+// change is statistically significant, so it can gate CI
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const char *const BENCHSTORE_DIR = "benchresults";
+const char *const BENCHSTORE_THRESHOLDS = "benchthresholds.txt";
+
+// percent change allowed for metrics no thresholds line matches
+const double BENCHSTORE_DEFAULT_THRESHOLD = 10.0;
+
+// two sided 95% Student t quantiles for 1...30 degrees of freedom
+const double T_95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+					   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+					   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+// "benchmark.metric" -> one value per stored run
+typedef std::map<std::string, std::vector<double>> Samples;
+
+struct Threshold
+{
+	std::string pattern; // * matches any run of characters
+	double percent;
+};
+
+// one {"benchmark": name, "metrics": {name: number, ...}, "settings": {...}} file, see BenchmarkResults::write
+class ResultsParser
+{
+private:
+	std::string text;
+	size_t position = 0;
+
+	void skipSpace()
+	{
+		while (position < text.size() && isspace((unsigned char)text[position]))
+			position++;
+	}
+
+	bool expect(char c)
+	{
+		skipSpace();
+		if (position < text.size() && text[position] == c)
+		{
+			position++;
+			return true;
+		}
+		return false;
+	}
+
+	bool parseString(std::string &out)
+	{
+		if (!expect('"'))
+			return false;
+
+		out.clear();
+		while (position < text.size() && text[position] != '"')
+		{
+			if (text[position] == '\\' && position + 1 < text.size())
+				position++;
+			out += text[position++];
+		}
+		return expect('"');
+	}
+
+	bool parseNumber(double &out)
+	{
+		skipSpace();
+		const char *start = text.c_str() + position;
+		char *end;
+		out = strtod(start, &end);
+		position += end - start;
+		return end != start;
+	}
+
+public:
+	ResultsParser(const std::string &text) : text(text) {}
+
+	bool parse(std::string &benchmark, std::vector<std::pair<std::string, double>> &metrics)
+	{
+		if (!expect('{'))
+			return false;
+
+		do
+		{
+			std::string key;
+			if (!parseString(key) || !expect(':'))
+				return false;
+
+			if (key == "benchmark")
+			{
+				if (!parseString(benchmark))
+					return false;
+			}
+			else if (key == "metrics" || key == "settings")
+			{
+				if (!expect('{'))
+					return false;
+				if (expect('}'))
+					continue;
+
+				// settings are parsed to stay strict about the format, but never compared
+				do
+				{
+					std::string metric;
+					double value;
+					if (!parseString(metric) || !expect(':') || !parseNumber(value))
+						return false;
+					if (key == "metrics")
+						metrics.push_back({metric, value});
+				} while (expect(','));
+
+				if (!expect('}'))
+					return false;
+			}
+			else
+			{
+				return false;
+			}
+		} while (expect(','));
+
+		return expect('}') && !benchmark.empty();
+	}
+};
+
+bool readResults(const std::string &filePath, std::string &benchmark, std::vector<std::pair<std::string, double>> &metrics)
+{
+	std::ifstream file(filePath);
+	if (!file)
+	{
+		std::cout << "ERROR::BENCHSTORE::FILE_NOT_SUCCESFULLY_READ: " << filePath << std::endl;
+		return false;
+	}
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+
+	if (!ResultsParser(stream.str()).parse(benchmark, metrics))
+	{
+		std::cout << "ERROR::BENCHSTORE::NOT_A_RESULTS_FILE: " << filePath << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// copies a results file to store/commit/benchmark.N.json, N counts the runs
+int add(const std::string &store, const std::string &commit, const std::string &filePath)
+{
+	std::string benchmark;
+	std::vector<std::pair<std::string, double>> metrics;
+	if (!readResults(filePath, benchmark, metrics))
+		return -1;
+
+	std::filesystem::path directory = std::filesystem::path(store) / commit;
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	int run = 0;
+	while (std::filesystem::exists(directory / (benchmark + "." + std::to_string(run) + ".json")))
+		run++;
+
+	std::filesystem::path target = directory / (benchmark + "." + std::to_string(run) + ".json");
+	if (!std::filesystem::copy_file(filePath, target, error))
+	{
+		std::cout << "ERROR::BENCHSTORE::CANNOT_WRITE: " << target.string() << std::endl;
+		return -1;
+	}
+
+	std::cout << commit << ": stored " << benchmark << " run " << run + 1 << " (" << metrics.size() << " metrics)" << std::endl;
+	return 0;
+}
+
+bool loadCommit(const std::string &store, const std::string &commit, Samples &samples)
+{
+	std::filesystem::path directory = std::filesystem::path(store) / commit;
+	std::error_code error;
+	if (!std::filesystem::is_directory(directory, error))
+	{
+		std::cout << "ERROR::BENCHSTORE::NO_RESULTS_FOR: " << commit << std::endl;
+		return false;
+	}
+
+	for (const auto &entry : std::filesystem::directory_iterator(directory))
+	{
+		if (entry.path().extension() != ".json")
+			continue;
+
+		std::string benchmark;
+		std::vector<std::pair<std::string, double>> metrics;
+		if (!readResults(entry.path().string(), benchmark, metrics))
+			return false;
+
+		for (const auto &metric : metrics)
+			samples[benchmark + "." + metric.first].push_back(metric.second);
+	}
+
+	return true;
+}
+
+// pattern percent per line, # starts a comment. the first matching line wins
+std::vector<Threshold> loadThresholds(const std::string &filePath)
+{
+	std::vector<Threshold> thresholds;
+
+	std::ifstream file(filePath);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		Threshold threshold;
+		if (fields >> threshold.pattern >> threshold.percent)
+			thresholds.push_back(threshold);
+	}
+
+	return thresholds;
+}
+
+bool matches(const char *pattern, const char *name)
+{
+	if (*pattern == '\0')
+		return *name == '\0';
+	if (*pattern == '*')
+		return matches(pattern + 1, name) || (*name && matches(pattern, name + 1));
+	return *pattern == *name && matches(pattern + 1, name + 1);
+}
+
+double thresholdFor(const std::vector<Threshold> &thresholds, const std::string &name)
+{
+	for (const Threshold &threshold : thresholds)
+	{
+		if (matches(threshold.pattern.c_str(), name.c_str()))
+			return threshold.percent;
+	}
+	return BENCHSTORE_DEFAULT_THRESHOLD;
+}
+
+// +1 if larger is better, -1 if smaller is better, 0 for counts and settings that aren't scored
+int direction(const std::string &name)
+{
+	if (name.find("_ms") != std::string::npos || name.find("ns_per") != std::string::npos ||
+		name.find("hitches") != std::string::npos || name.find("not_ready") != std::string::npos ||
+		name.find("_bytes") != std::string::npos || name.find("allocations") != std::string::npos ||
+		name.find("mismatches") != std::string::npos)
+		return -1;
+	if (name.find("per_s") != std::string::npos || name.find("score") != std::string::npos)
+		return 1;
+	return 0;
+}
+
+double tQuantile(double degreesOfFreedom)
+{
+	int index = (int)degreesOfFreedom;
+	if (index < 1)
+		index = 1;
+	return index <= 30 ? T_95[index - 1] : 1.96;
+}
+
+struct Summary
+{
+	double mean = 0.0;
+	double variance = 0.0; // sample variance
+	int count = 0;
+};
+
+Summary summarize(const std::vector<double> &values)
+{
+	Summary summary;
+	summary.count = values.size();
+
+	for (double value : values)
+		summary.mean += value;
+	summary.mean /= summary.count;
+
+	for (double value : values)
+		summary.variance += (value - summary.mean) * (value - summary.mean);
+	summary.variance = summary.count > 1 ? summary.variance / (summary.count - 1) : 0.0;
+
+	return summary;
+}
+
+// half width of the 95% confidence interval of the mean
+double confidence(const Summary &summary)
+{
+	return summary.count > 1 ? tQuantile(summary.count - 1) * std::sqrt(summary.variance / summary.count) : 0.0;
+}
+
+int compare(const std::string &store, const std::string &baseline, const std::string &candidate, const std::string &thresholdsFile)
+{
+	Samples before, after;
+	if (!loadCommit(store, baseline, before) || !loadCommit(store, candidate, after))
+		return -1;
+
+	std::vector<Threshold> thresholds = loadThresholds(thresholdsFile);
+
+	int regressions = 0;
+	int improvements = 0;
+	int compared = 0;
+
+	for (const auto &metric : after)
+	{
+		const std::string &name = metric.first;
+		int better = direction(name);
+		if (better == 0 || !before.count(name))
+			continue;
+
+		Summary a = summarize(before[name]);
+		Summary b = summarize(metric.second);
+		// counts like hitches can start at zero, any increase from there is unbounded
+		double change = a.mean != 0.0 ? (b.mean - a.mean) / std::fabs(a.mean) * 100.0 : b.mean == 0.0 ? 0.0 : std::copysign(HUGE_VAL, b.mean);
+		double threshold = thresholdFor(thresholds, name);
+
+		// Welch's t-test on the difference of the means. with a single run on
+		// either side there is no variance, so only the threshold applies
+		bool significant = true;
+		if (a.count > 1 && b.count > 1)
+		{
+			double va = a.variance / a.count;
+			double vb = b.variance / b.count;
+			double standardError = std::sqrt(va + vb);
+			double degreesOfFreedom = (va + vb) * (va + vb) / (va * va / (a.count - 1) + vb * vb / (b.count - 1) + 1e-300);
+			significant = standardError == 0.0 ? a.mean != b.mean : std::fabs(b.mean - a.mean) > tQuantile(degreesOfFreedom) * standardError;
+		}
+
+		double worse = -better * change;
+		const char *status = "ok";
+		if (significant && worse > threshold)
+		{
+			status = "REGRESSION";
+			regressions++;
+		}
+		else if (significant && worse < -threshold)
+		{
+			status = "improved";
+			improvements++;
+		}
+		else if (!significant && std::fabs(change) > threshold)
+		{
+			status = "noise";
+		}
+		compared++;
+
+		char line[512];
+		snprintf(line, sizeof(line), "%-60s %12.4g +- %-10.3g %12.4g +- %-10.3g %+8.2f%% (limit %.1f%%, n=%d/%d) %s",
+				 name.c_str(), a.mean, confidence(a), b.mean, confidence(b), change, threshold, a.count, b.count, status);
+		std::cout << line << std::endl;
+	}
+
+	std::cout << baseline << " -> " << candidate << ": " << compared << " metrics, " << regressions << " regressions, "
+			  << improvements << " improvements" << std::endl;
+
+	return regressions ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	std::string store = BENCHSTORE_DIR;
+	std::string thresholdsFile = BENCHSTORE_THRESHOLDS;
+	std::vector<std::string> arguments;
+
+	for (int i = 1; i < argc; i++)
+	{
+		auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : ""; };
+
+		if (strcmp(argv[i], "--store") == 0)
+			store = value();
+		else if (strcmp(argv[i], "--thresholds") == 0)
+			thresholdsFile = value();
+		else
+			arguments.push_back(argv[i]);
+	}
+
+	if (arguments.size() >= 3 && arguments[0] == "add")
+	{
+		for (size_t i = 2; i < arguments.size(); i++)
+		{
+			if (add(store, arguments[1], arguments[i]) != 0)
+				return -1;
+		}
+		return 0;
+	}
+
+	if (arguments.size() == 3 && arguments[0] == "compare")
+		return compare(store, arguments[1], arguments[2], thresholdsFile);
+
+	std::cout << "usage: benchstore add <commit> <results.json>..." << std::endl
+			  << "       benchstore compare <baseline> <candidate> [--thresholds file] [--store dir]" << std::endl;
+	return -1;
+}
@@ -67,18 +67,24 @@ public:
 
 	void rotateMouseToAngles(float xoffset, float yoffset)
 	{
-		yaw += xoffset * cameraSens;
-		pitch += yoffset * cameraSens;
+		setAngles(yaw + xoffset * cameraSens, pitch + yoffset * cameraSens);
+	}
+
+	// absolute orientation in degrees, used by scripted camera paths
+	void setAngles(float yaw, float pitch)
+	{
+		this->yaw = yaw;
+		this->pitch = pitch;
 
-		if (pitch > 89.0f)
-			pitch = 89.0f;
-		if (pitch < -89.0f)
-			pitch = -89.0f;
+		if (this->pitch > 89.0f)
+			this->pitch = 89.0f;
+		if (this->pitch < -89.0f)
+			this->pitch = -89.0f;
 
 		glm::vec3 direction;
-		direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-		direction.y = sin(glm::radians(pitch));
-		direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+		direction.x = cos(glm::radians(this->yaw)) * cos(glm::radians(this->pitch));
+		direction.y = sin(glm::radians(this->pitch));
+		direction.z = sin(glm::radians(this->yaw)) * cos(glm::radians(this->pitch));
 		cameraDirection = glm::normalize(direction);
 	}
 	glm::mat4 getViewMatrix()
@@ -91,10 +97,25 @@ public:
 		return cameraPosition;
 	}
 
+	float getYaw()
+	{
+		return yaw;
+	}
+
+	float getPitch()
+	{
+		return pitch;
+	}
+
 	void setSpeed(float speed)
 	{
 		this->cameraSpeed = speed;
 	}
+
+	void setWorldPosition(glm::vec3 position)
+	{
+		cameraPosition = position;
+	}
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+// https://learnopengl.com/code_viewer_gh.php?code=includes/learnopengl/shader_c.h
+
+#ifndef COMPUTE_SHADER_H
+#define COMPUTE_SHADER_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <string.h>
+#include <chrono>
+
+#include "programcache.h"
+
+class ComputeShader
+{
+public:
+	unsigned int ID = 0;
+	// constructor only records the path, compile() reads it and needs a GL 4.3 context
+	// ------------------------------------------------------------------------
+	ComputeShader(const char *computePath) : computePath(computePath)
+	{
+	}
+
+	// returns false if the shader failed to compile or link
+	bool compile()
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		load();
+
+		ID = glCreateProgram();
+		uint64_t cacheKey = ProgramCache::key({computeCode});
+		bool cached = ProgramCache::load(ID, cacheKey);
+		bool success = cached;
+
+		if (!cached)
+		{
+			glDeleteProgram(ID);
+			success = link();
+			if (success)
+				ProgramCache::save(ID, cacheKey);
+		}
+
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "shader " << computePath << ": "
+				  << (cached ? "program cache hit" : "compiled from source") << " in " << elapsed << " ms" << std::endl;
+
+		return success;
+	}
+	// activate the shader
+	// ------------------------------------------------------------------------
+	void use()
+	{
+		glUseProgram(ID);
+	}
+	// utility uniform functions
+	// ------------------------------------------------------------------------
+	void setInt(const std::string &name, int value) const
+	{
+		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+	}
+	// ------------------------------------------------------------------------
+	void setFloat(const std::string &name, float value) const
+	{
+		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+	}
+	// ------------------------------------------------------------------------
+	void setIVec2(const std::string &name, int x, int y) const
+	{
+		setIVec2(glGetUniformLocation(ID, name.c_str()), x, y);
+	}
+	// ------------------------------------------------------------------------
+	int getUniformLocation(const std::string &name) const
+	{
+		return glGetUniformLocation(ID, name.c_str());
+	}
+
+	void setIVec2(int location, int x, int y) const
+	{
+		glUniform2i(location, x, y);
+	}
+
+private:
+	std::string computePath;
+	std::string computeCode;
+
+	void load()
+	{
+		std::ifstream cShaderFile;
+		// ensure ifstream objects can throw exceptions:
+		cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+		try
+		{
+			cShaderFile.open(computePath);
+			std::stringstream cShaderStream;
+			cShaderStream << cShaderFile.rdbuf();
+			cShaderFile.close();
+			computeCode = cShaderStream.str();
+		}
+		catch (std::ifstream::failure &e)
+		{
+			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
+		}
+	}
+
+	bool link()
+	{
+		const char *cShaderCode = computeCode.c_str();
+		unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+		glShaderSource(compute, 1, &cShaderCode, NULL);
+		glCompileShader(compute);
+		bool success = checkCompileErrors(compute, "COMPUTE");
+
+		ID = glCreateProgram();
+		glAttachShader(ID, compute);
+		ProgramCache::prepare(ID);
+		glLinkProgram(ID);
+		success = checkCompileErrors(ID, "PROGRAM") && success;
+
+		glDeleteShader(compute);
+		return success;
+	}
+	// utility function for checking shader compilation/linking errors.
+	// ------------------------------------------------------------------------
+	bool checkCompileErrors(unsigned int shader, std::string type)
+	{
+		int success;
+		char infoLog[1024];
+		if (type != "PROGRAM")
+		{
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+			if (!success)
+			{
+				glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+				std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n"
+						  << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+			}
+		}
+		else
+		{
+			glGetProgramiv(shader, GL_LINK_STATUS, &success);
+			if (!success)
+			{
+				glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+				std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n"
+						  << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+			}
+		}
+		return success;
+	}
+};
+#endif
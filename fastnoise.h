@@ -125,6 +125,7 @@ public:
 		mGain = 0.5f;
 		mWeightedStrength = 0.0f;
 		mPingPongStrength = 2.0f;
+		mLodThreshold = 2.0f;
 
 		mFractalBounding = 1 / 1.75f;
 
@@ -237,6 +238,15 @@ public:
 	/// </remarks>
 	void SetFractalPingPongStrength(float pingPongStrength) { mPingPongStrength = pingPongStrength; }
 
+	/// <summary>
+	/// Sets the shortest octave wavelength GetNoiseLod(...) keeps, in sample footprints
+	/// </summary>
+	/// <remarks>
+	/// Default: 2.0 (the Nyquist limit)
+	/// Note: Larger values drop more octaves
+	/// </remarks>
+	void SetFractalLodThreshold(float lodThreshold) { mLodThreshold = lodThreshold; }
+
 	/// <summary>
 	/// Sets distance function used in cellular noise calculations
 	/// </summary>
@@ -282,6 +292,67 @@ public:
 	/// </remarks>
 	void SetDomainWarpAmp(float domainWarpAmp) { mDomainWarpAmp = domainWarpAmp; }
 
+	/// <summary>
+	/// Current settings, for mirroring the generator outside of this class (e.g. GPU kernels)
+	/// </summary>
+	int GetSeed() const { return mSeed; }
+	float GetFrequency() const { return mFrequency; }
+	NoiseType GetNoiseType() const { return mNoiseType; }
+	FractalType GetFractalType() const { return mFractalType; }
+	int GetFractalOctaves() const { return mOctaves; }
+	float GetFractalLacunarity() const { return mLacunarity; }
+	float GetFractalGain() const { return mGain; }
+	float GetFractalWeightedStrength() const { return mWeightedStrength; }
+	float GetFractalBounding() const { return mFractalBounding; }
+	float GetFractalPingPongStrength() const { return mPingPongStrength; }
+	float GetFractalLodThreshold() const { return mLodThreshold; }
+	CellularDistanceFunction GetCellularDistanceFunction() const { return mCellularDistanceFunction; }
+	CellularReturnType GetCellularReturnType() const { return mCellularReturnType; }
+	float GetCellularJitter() const { return mCellularJitterModifier; }
+	DomainWarpType GetDomainWarpType() const { return mDomainWarpType; }
+	float GetDomainWarpAmp() const { return mDomainWarpAmp; }
+
+	/// <summary>
+	/// Octaves GetNoiseLod(...) evaluates for samples footprint apart
+	/// </summary>
+	/// <remarks>
+	/// Between 1 and the octave count, the fraction is the fade of the last octave.
+	/// Returns the octave count for a footprint of 0 or a lacunarity of 1 or less
+	/// </remarks>
+	float GetFractalOctavesForFootprint(float footprint) const
+	{
+		if (mFractalType == FractalType_None || footprint <= 0 || mLacunarity <= 1)
+			return (float)mOctaves;
+
+		// octave i has a wavelength of 1 / (frequency * lacunarity^i)
+		float octaves = 1 + logf(1 / (mFrequency * footprint * mLodThreshold)) / logf(mLacunarity);
+		return octaves < 1 ? 1.0f : octaves > mOctaves ? (float)mOctaves : octaves;
+	}
+
+	/// <summary>
+	/// 2D gradient table used by GradCoord(...)
+	/// </summary>
+	/// <remarks>
+	/// 128 gradients stored as 256 interleaved x, y floats
+	/// </remarks>
+	static const float *GetGradients2D() { return Lookup<float>::Gradients2D; }
+
+	/// <summary>
+	/// 2D random vector table used by the BasicGrid domain warp and cellular noise
+	/// </summary>
+	/// <remarks>
+	/// 256 vectors stored as 512 interleaved x, y floats
+	/// </remarks>
+	static const float *GetRandVecs2D() { return Lookup<float>::RandVecs2D; }
+
+	/// <summary>
+	/// Bytes taken by the static gradient and random vector tables
+	/// </summary>
+	/// <remarks>
+	/// Gradients2D 256, RandVecs2D 512, Gradients3D 256 and RandVecs3D 1024 floats
+	/// </remarks>
+	static constexpr size_t GetLookupTableSize() { return (256 + 512 + 256 + 1024) * sizeof(float); }
+
 	/// <summary>
 	/// 2D noise at given position using current settings
 	/// </summary>
@@ -289,7 +360,7 @@ public:
 	/// Noise output bounded between -1...1
 	/// </returns>
 	template <typename FNfloat>
-	float GetNoise(FNfloat x, FNfloat y)
+	float GetNoise(FNfloat x, FNfloat y) const
 	{
 		Arguments_must_be_floating_point_values<FNfloat>();
 
@@ -315,7 +386,7 @@ public:
 	/// Noise output bounded between -1...1
 	/// </returns>
 	template <typename FNfloat>
-	float GetNoise(FNfloat x, FNfloat y, FNfloat z)
+	float GetNoise(FNfloat x, FNfloat y, FNfloat z) const
 	{
 		Arguments_must_be_floating_point_values<FNfloat>();
 
@@ -334,6 +405,266 @@ public:
 		}
 	}
 
+	/// <summary>
+	/// 2D noise at given position, skipping the octaves too fine for the sample footprint
+	/// </summary>
+	/// <remarks>
+	/// footprint is the world space distance between neighbouring samples, e.g. the
+	/// camera distance times the angle of a pixel. The last kept octave fades in smoothly
+	/// so nothing pops as the footprint changes. The output stays normalized for the full
+	/// octave count: it equals GetNoise(x, y) without the fine detail, and exactly
+	/// GetNoise(x, y) when every octave is kept
+	/// </remarks>
+	template <typename FNfloat>
+	float GetNoiseLod(FNfloat x, FNfloat y, float footprint) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		TransformNoiseCoordinate(x, y);
+
+		switch (mFractalType)
+		{
+		default:
+			return GenNoiseSingle(mSeed, x, y);
+		case FractalType_FBm:
+		case FractalType_Ridged:
+		case FractalType_PingPong:
+		{
+			float amp = mFractalBounding;
+			return GenFractalLod(x, y, 0, GetFractalOctavesForFootprint(footprint), amp);
+		}
+		}
+	}
+
+	/// <summary>
+	/// 3D noise at given position, skipping the octaves too fine for the sample footprint
+	/// </summary>
+	/// <remarks>
+	/// See GetNoiseLod(x, y, footprint)
+	/// </remarks>
+	template <typename FNfloat>
+	float GetNoiseLod(FNfloat x, FNfloat y, FNfloat z, float footprint) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		TransformNoiseCoordinate(x, y, z);
+
+		switch (mFractalType)
+		{
+		default:
+			return GenNoiseSingle(mSeed, x, y, z);
+		case FractalType_FBm:
+		case FractalType_Ridged:
+		case FractalType_PingPong:
+		{
+			float amp = mFractalBounding;
+			return GenFractalLod(x, y, z, 0, GetFractalOctavesForFootprint(footprint), amp);
+		}
+		}
+	}
+
+	/// <summary>
+	/// 2D noise of a single fractal octave before it's weighted, bounded between -1...1
+	/// </summary>
+	/// <remarks>
+	/// Octave i uses seed + i and coordinates scaled by lacunarity^i, feed the octaves
+	/// in order to AddOctave(...) to get GetNoise(x, y)
+	/// </remarks>
+	template <typename FNfloat>
+	float GetNoiseOctave(FNfloat x, FNfloat y, int octave) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		TransformNoiseCoordinate(x, y);
+
+		for (int i = 0; i < octave; i++)
+		{
+			x *= mLacunarity;
+			y *= mLacunarity;
+		}
+
+		return GenNoiseSingle(mSeed + octave, x, y);
+	}
+
+	/// <summary>
+	/// 3D noise of a single fractal octave before it's weighted, bounded between -1...1
+	/// </summary>
+	/// <remarks>
+	/// See GetNoiseOctave(x, y, octave)
+	/// </remarks>
+	template <typename FNfloat>
+	float GetNoiseOctave(FNfloat x, FNfloat y, FNfloat z, int octave) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		TransformNoiseCoordinate(x, y, z);
+
+		for (int i = 0; i < octave; i++)
+		{
+			x *= mLacunarity;
+			y *= mLacunarity;
+			z *= mLacunarity;
+		}
+
+		return GenNoiseSingle(mSeed + octave, x, y, z);
+	}
+
+	/// <summary>
+	/// Adds the next octave from GetNoiseOctave(...) to a fractal sum like GetNoise(...) does
+	/// </summary>
+	/// <remarks>
+	/// Start with sum = 0 and amp = GetFractalBounding(), amp is updated for the next
+	/// octave. Without a fractal the sum is the noise of octave 0. FBm weighting clamps
+	/// the noise at 1 like the 2D fractal, the 3D one only differs for noise above 1
+	/// </remarks>
+	void AddOctave(float noise, float &sum, float &amp) const
+	{
+		switch (mFractalType)
+		{
+		default:
+			sum = noise;
+			return;
+		case FractalType_FBm:
+			sum += noise * amp;
+			amp *= Lerp(1.0f, FastMin(noise + 1, 2) * 0.5f, mWeightedStrength);
+			break;
+		case FractalType_Ridged:
+			noise = FastAbs(noise);
+			sum += (noise * -2 + 1) * amp;
+			amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+			break;
+		case FractalType_PingPong:
+			noise = PingPong((noise + 1) * mPingPongStrength);
+			sum += (noise - 0.5f) * 2 * amp;
+			amp *= Lerp(1.0f, noise, mWeightedStrength);
+			break;
+		}
+
+		amp *= mGain;
+	}
+
+	/// <summary>
+	/// 2D fractal noise of octaves first...last - 1 only
+	/// </summary>
+	/// <remarks>
+	/// amp is the amplitude of octave first, GetFractalBounding() for octave 0, and is
+	/// updated to the amplitude of octave last. Consecutive ranges add up to GetNoise(x, y)
+	/// up to float rounding. Without a fractal, octave 0 is the plain noise
+	/// </remarks>
+	template <typename FNfloat>
+	float GetNoiseOctaves(FNfloat x, FNfloat y, int first, int last, float &amp) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		TransformNoiseCoordinate(x, y);
+
+		switch (mFractalType)
+		{
+		default:
+			return first == 0 && last > 0 ? GenNoiseSingle(mSeed, x, y) : 0;
+		case FractalType_FBm:
+		case FractalType_Ridged:
+		case FractalType_PingPong:
+			return GenFractalLod(x, y, first, (float)(last < mOctaves ? last : mOctaves), amp);
+		}
+	}
+
+	/// <summary>
+	/// 3D fractal noise of octaves first...last - 1 only
+	/// </summary>
+	/// <remarks>
+	/// See GetNoiseOctaves(x, y, first, last, amp)
+	/// </remarks>
+	template <typename FNfloat>
+	float GetNoiseOctaves(FNfloat x, FNfloat y, FNfloat z, int first, int last, float &amp) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		TransformNoiseCoordinate(x, y, z);
+
+		switch (mFractalType)
+		{
+		default:
+			return first == 0 && last > 0 ? GenNoiseSingle(mSeed, x, y, z) : 0;
+		case FractalType_FBm:
+		case FractalType_Ridged:
+		case FractalType_PingPong:
+			return GenFractalLod(x, y, z, first, (float)(last < mOctaves ? last : mOctaves), amp);
+		}
+	}
+
+	/// <summary>
+	/// 2D noise at count positions using current settings
+	/// </summary>
+	/// <remarks>
+	/// Same output as calling GetNoise(x[i], y[i]) for every i
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseBatch(const FNfloat *x, const FNfloat *y, float *out, int count) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int i = 0; i < count; i++)
+			out[i] = GetNoise(x[i], y[i]);
+	}
+
+	/// <summary>
+	/// 3D noise at count positions using current settings
+	/// </summary>
+	/// <remarks>
+	/// Same output as calling GetNoise(x[i], y[i], z[i]) for every i
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseBatch(const FNfloat *x, const FNfloat *y, const FNfloat *z, float *out, int count) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int i = 0; i < count; i++)
+			out[i] = GetNoise(x[i], y[i], z[i]);
+	}
+
+	/// <summary>
+	/// 2D noise on a width x height grid of points step apart, starting at (xStart, yStart)
+	/// </summary>
+	/// <remarks>
+	/// Written row by row with x fastest: out[y * width + x]
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseGrid(FNfloat xStart, FNfloat yStart, FNfloat step, int width, int height, float *out) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int y = 0; y < height; y++)
+		{
+			FNfloat yPos = yStart + y * step;
+			for (int x = 0; x < width; x++)
+				*out++ = GetNoise(xStart + x * step, yPos);
+		}
+	}
+
+	/// <summary>
+	/// 3D noise on a width x height x depth grid of points step apart, starting at (xStart, yStart, zStart)
+	/// </summary>
+	/// <remarks>
+	/// Written slice by slice with x fastest: out[(z * height + y) * width + x]
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseGrid(FNfloat xStart, FNfloat yStart, FNfloat zStart, FNfloat step, int width, int height, int depth, float *out) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int z = 0; z < depth; z++)
+		{
+			FNfloat zPos = zStart + z * step;
+			for (int y = 0; y < height; y++)
+			{
+				FNfloat yPos = yStart + y * step;
+				for (int x = 0; x < width; x++)
+					*out++ = GetNoise(xStart + x * step, yPos, zPos);
+			}
+		}
+	}
+
 	/// <summary>
 	/// 2D warps the input position using current domain warp settings
 	/// </summary>
@@ -343,7 +674,7 @@ public:
 	/// noise = GetNoise(x, y)</code>
 	/// </example>
 	template <typename FNfloat>
-	void DomainWarp(FNfloat &x, FNfloat &y)
+	void DomainWarp(FNfloat &x, FNfloat &y) const
 	{
 		Arguments_must_be_floating_point_values<FNfloat>();
 
@@ -370,7 +701,7 @@ public:
 	/// noise = GetNoise(x, y, z)</code>
 	/// </example>
 	template <typename FNfloat>
-	void DomainWarp(FNfloat &x, FNfloat &y, FNfloat &z)
+	void DomainWarp(FNfloat &x, FNfloat &y, FNfloat &z) const
 	{
 		Arguments_must_be_floating_point_values<FNfloat>();
 
@@ -388,6 +719,131 @@ public:
 		}
 	}
 
+	/// <summary>
+	/// 2D warps count positions in place using current domain warp settings
+	/// </summary>
+	/// <remarks>
+	/// Same output as calling DomainWarp(x[i], y[i]) for every i
+	/// </remarks>
+	template <typename FNfloat>
+	void DomainWarpBatch(FNfloat *x, FNfloat *y, int count) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int i = 0; i < count; i++)
+			DomainWarp(x[i], y[i]);
+	}
+
+	/// <summary>
+	/// 3D warps count positions in place using current domain warp settings
+	/// </summary>
+	/// <remarks>
+	/// Same output as calling DomainWarp(x[i], y[i], z[i]) for every i
+	/// </remarks>
+	template <typename FNfloat>
+	void DomainWarpBatch(FNfloat *x, FNfloat *y, FNfloat *z, int count) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int i = 0; i < count; i++)
+			DomainWarp(x[i], y[i], z[i]);
+	}
+
+	/// <summary>
+	/// 2D noise at count positions warped by the domain warp settings of warp
+	/// </summary>
+	/// <remarks>
+	/// Same output as warp.DomainWarp(x, y) then GetNoise(x, y) for every position,
+	/// the warped positions are never written back. warp may be this object
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseWarpedBatch(const FastNoiseLite &warp, const FNfloat *x, const FNfloat *y, float *out, int count) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int i = 0; i < count; i++)
+		{
+			FNfloat xw = x[i];
+			FNfloat yw = y[i];
+			warp.DomainWarp(xw, yw);
+			out[i] = GetNoise(xw, yw);
+		}
+	}
+
+	/// <summary>
+	/// 3D noise at count positions warped by the domain warp settings of warp
+	/// </summary>
+	/// <remarks>
+	/// See GetNoiseWarpedBatch(warp, x, y, out, count)
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseWarpedBatch(const FastNoiseLite &warp, const FNfloat *x, const FNfloat *y, const FNfloat *z, float *out, int count) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int i = 0; i < count; i++)
+		{
+			FNfloat xw = x[i];
+			FNfloat yw = y[i];
+			FNfloat zw = z[i];
+			warp.DomainWarp(xw, yw, zw);
+			out[i] = GetNoise(xw, yw, zw);
+		}
+	}
+
+	/// <summary>
+	/// 2D noise on a grid like GetNoiseGrid(...), every point warped by warp first
+	/// </summary>
+	/// <remarks>
+	/// Same output as warp.DomainWarp(x, y) then GetNoise(x, y) for every grid point
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseWarpedGrid(const FastNoiseLite &warp, FNfloat xStart, FNfloat yStart, FNfloat step, int width, int height, float *out) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int y = 0; y < height; y++)
+		{
+			FNfloat yPos = yStart + y * step;
+			for (int x = 0; x < width; x++)
+			{
+				FNfloat xw = xStart + x * step;
+				FNfloat yw = yPos;
+				warp.DomainWarp(xw, yw);
+				*out++ = GetNoise(xw, yw);
+			}
+		}
+	}
+
+	/// <summary>
+	/// 3D noise on a grid like GetNoiseGrid(...), every point warped by warp first
+	/// </summary>
+	/// <remarks>
+	/// Same output as warp.DomainWarp(x, y, z) then GetNoise(x, y, z) for every grid point
+	/// </remarks>
+	template <typename FNfloat>
+	void GetNoiseWarpedGrid(const FastNoiseLite &warp, FNfloat xStart, FNfloat yStart, FNfloat zStart, FNfloat step, int width, int height, int depth, float *out) const
+	{
+		Arguments_must_be_floating_point_values<FNfloat>();
+
+		for (int z = 0; z < depth; z++)
+		{
+			FNfloat zPos = zStart + z * step;
+			for (int y = 0; y < height; y++)
+			{
+				FNfloat yPos = yStart + y * step;
+				for (int x = 0; x < width; x++)
+				{
+					FNfloat xw = xStart + x * step;
+					FNfloat yw = yPos;
+					FNfloat zw = zPos;
+					warp.DomainWarp(xw, yw, zw);
+					*out++ = GetNoise(xw, yw, zw);
+				}
+			}
+		}
+	}
+
 private:
 	template <typename T>
 	struct Arguments_must_be_floating_point_values;
@@ -412,6 +868,7 @@ private:
 	float mGain;
 	float mWeightedStrength;
 	float mPingPongStrength;
+	float mLodThreshold;
 
 	float mFractalBounding;
 
@@ -516,7 +973,7 @@ private:
 		return hash * (1 / 2147483648.0f);
 	}
 
-	float GradCoord(int seed, int xPrimed, int yPrimed, float xd, float yd)
+	float GradCoord(int seed, int xPrimed, int yPrimed, float xd, float yd) const
 	{
 		int hash = Hash(seed, xPrimed, yPrimed);
 		hash ^= hash >> 15;
@@ -528,7 +985,7 @@ private:
 		return xd * xg + yd * yg;
 	}
 
-	float GradCoord(int seed, int xPrimed, int yPrimed, int zPrimed, float xd, float yd, float zd)
+	float GradCoord(int seed, int xPrimed, int yPrimed, int zPrimed, float xd, float yd, float zd) const
 	{
 		int hash = Hash(seed, xPrimed, yPrimed, zPrimed);
 		hash ^= hash >> 15;
@@ -541,7 +998,7 @@ private:
 		return xd * xg + yd * yg + zd * zg;
 	}
 
-	void GradCoordOut(int seed, int xPrimed, int yPrimed, float &xo, float &yo)
+	void GradCoordOut(int seed, int xPrimed, int yPrimed, float &xo, float &yo) const
 	{
 		int hash = Hash(seed, xPrimed, yPrimed) & (255 << 1);
 
@@ -549,7 +1006,7 @@ private:
 		yo = Lookup<float>::RandVecs2D[hash | 1];
 	}
 
-	void GradCoordOut(int seed, int xPrimed, int yPrimed, int zPrimed, float &xo, float &yo, float &zo)
+	void GradCoordOut(int seed, int xPrimed, int yPrimed, int zPrimed, float &xo, float &yo, float &zo) const
 	{
 		int hash = Hash(seed, xPrimed, yPrimed, zPrimed) & (255 << 2);
 
@@ -558,7 +1015,7 @@ private:
 		zo = Lookup<float>::RandVecs3D[hash | 2];
 	}
 
-	void GradCoordDual(int seed, int xPrimed, int yPrimed, float xd, float yd, float &xo, float &yo)
+	void GradCoordDual(int seed, int xPrimed, int yPrimed, float xd, float yd, float &xo, float &yo) const
 	{
 		int hash = Hash(seed, xPrimed, yPrimed);
 		int index1 = hash & (127 << 1);
@@ -575,7 +1032,7 @@ private:
 		yo = value * ygo;
 	}
 
-	void GradCoordDual(int seed, int xPrimed, int yPrimed, int zPrimed, float xd, float yd, float zd, float &xo, float &yo, float &zo)
+	void GradCoordDual(int seed, int xPrimed, int yPrimed, int zPrimed, float xd, float yd, float zd, float &xo, float &yo, float &zo) const
 	{
 		int hash = Hash(seed, xPrimed, yPrimed, zPrimed);
 		int index1 = hash & (63 << 2);
@@ -598,7 +1055,7 @@ private:
 	// Generic noise gen
 
 	template <typename FNfloat>
-	float GenNoiseSingle(int seed, FNfloat x, FNfloat y)
+	float GenNoiseSingle(int seed, FNfloat x, FNfloat y) const
 	{
 		switch (mNoiseType)
 		{
@@ -620,7 +1077,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float GenNoiseSingle(int seed, FNfloat x, FNfloat y, FNfloat z)
+	float GenNoiseSingle(int seed, FNfloat x, FNfloat y, FNfloat z) const
 	{
 		switch (mNoiseType)
 		{
@@ -644,7 +1101,7 @@ private:
 	// Noise Coordinate Transforms (frequency, and possible skew or rotation)
 
 	template <typename FNfloat>
-	void TransformNoiseCoordinate(FNfloat &x, FNfloat &y)
+	void TransformNoiseCoordinate(FNfloat &x, FNfloat &y) const
 	{
 		x *= mFrequency;
 		y *= mFrequency;
@@ -667,7 +1124,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void TransformNoiseCoordinate(FNfloat &x, FNfloat &y, FNfloat &z)
+	void TransformNoiseCoordinate(FNfloat &x, FNfloat &y, FNfloat &z) const
 	{
 		x *= mFrequency;
 		y *= mFrequency;
@@ -737,7 +1194,7 @@ private:
 	// Domain Warp Coordinate Transforms
 
 	template <typename FNfloat>
-	void TransformDomainWarpCoordinate(FNfloat &x, FNfloat &y)
+	void TransformDomainWarpCoordinate(FNfloat &x, FNfloat &y) const
 	{
 		switch (mDomainWarpType)
 		{
@@ -757,7 +1214,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void TransformDomainWarpCoordinate(FNfloat &x, FNfloat &y, FNfloat &z)
+	void TransformDomainWarpCoordinate(FNfloat &x, FNfloat &y, FNfloat &z) const
 	{
 		switch (mWarpTransformType3D)
 		{
@@ -823,7 +1280,7 @@ private:
 	// Fractal FBm
 
 	template <typename FNfloat>
-	float GenFractalFBm(FNfloat x, FNfloat y)
+	float GenFractalFBm(FNfloat x, FNfloat y) const
 	{
 		int seed = mSeed;
 		float sum = 0;
@@ -844,7 +1301,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float GenFractalFBm(FNfloat x, FNfloat y, FNfloat z)
+	float GenFractalFBm(FNfloat x, FNfloat y, FNfloat z) const
 	{
 		int seed = mSeed;
 		float sum = 0;
@@ -868,7 +1325,7 @@ private:
 	// Fractal Ridged
 
 	template <typename FNfloat>
-	float GenFractalRidged(FNfloat x, FNfloat y)
+	float GenFractalRidged(FNfloat x, FNfloat y) const
 	{
 		int seed = mSeed;
 		float sum = 0;
@@ -889,7 +1346,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float GenFractalRidged(FNfloat x, FNfloat y, FNfloat z)
+	float GenFractalRidged(FNfloat x, FNfloat y, FNfloat z) const
 	{
 		int seed = mSeed;
 		float sum = 0;
@@ -910,10 +1367,109 @@ private:
 		return sum;
 	}
 
+	// Fractal LOD, FBm, Ridged or PingPong over octaves first...last, last can be fractional.
+	// amp is the amplitude of octave first on entry and of the octave after last on return
+
+	template <typename FNfloat>
+	float GenFractalLod(FNfloat x, FNfloat y, int first, float last, float &amp) const
+	{
+		int seed = mSeed + first;
+		float sum = 0;
+
+		for (int i = 0; i < first; i++)
+		{
+			x *= mLacunarity;
+			y *= mLacunarity;
+		}
+
+		int full = (int)last;
+		float fade = InterpHermite(last - full);
+		int count = full < mOctaves && fade > 0 ? full + 1 : full;
+
+		for (int i = first; i < count; i++)
+		{
+			float noise = GenNoiseSingle(seed++, x, y);
+			float weight = i < full ? 1 : fade;
+
+			switch (mFractalType)
+			{
+			case FractalType_FBm:
+				sum += noise * amp * weight;
+				amp *= Lerp(1.0f, FastMin(noise + 1, 2) * 0.5f, mWeightedStrength);
+				break;
+			case FractalType_Ridged:
+				noise = FastAbs(noise);
+				sum += (noise * -2 + 1) * amp * weight;
+				amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+				break;
+			default:
+				noise = PingPong((noise + 1) * mPingPongStrength);
+				sum += (noise - 0.5f) * 2 * amp * weight;
+				amp *= Lerp(1.0f, noise, mWeightedStrength);
+				break;
+			}
+
+			x *= mLacunarity;
+			y *= mLacunarity;
+			amp *= mGain;
+		}
+
+		return sum;
+	}
+
+	template <typename FNfloat>
+	float GenFractalLod(FNfloat x, FNfloat y, FNfloat z, int first, float last, float &amp) const
+	{
+		int seed = mSeed + first;
+		float sum = 0;
+
+		for (int i = 0; i < first; i++)
+		{
+			x *= mLacunarity;
+			y *= mLacunarity;
+			z *= mLacunarity;
+		}
+
+		int full = (int)last;
+		float fade = InterpHermite(last - full);
+		int count = full < mOctaves && fade > 0 ? full + 1 : full;
+
+		for (int i = first; i < count; i++)
+		{
+			float noise = GenNoiseSingle(seed++, x, y, z);
+			float weight = i < full ? 1 : fade;
+
+			switch (mFractalType)
+			{
+			case FractalType_FBm:
+				sum += noise * amp * weight;
+				amp *= Lerp(1.0f, (noise + 1) * 0.5f, mWeightedStrength);
+				break;
+			case FractalType_Ridged:
+				noise = FastAbs(noise);
+				sum += (noise * -2 + 1) * amp * weight;
+				amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+				break;
+			default:
+				noise = PingPong((noise + 1) * mPingPongStrength);
+				sum += (noise - 0.5f) * 2 * amp * weight;
+				amp *= Lerp(1.0f, noise, mWeightedStrength);
+				break;
+			}
+
+			x *= mLacunarity;
+			y *= mLacunarity;
+			z *= mLacunarity;
+			amp *= mGain;
+		}
+
+		return sum;
+	}
+
 	// Fractal PingPong
 
 	template <typename FNfloat>
-	float GenFractalPingPong(FNfloat x, FNfloat y)
+	float GenFractalPingPong(FNfloat x, FNfloat y) const
 	{
 		int seed = mSeed;
 		float sum = 0;
@@ -934,7 +1490,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float GenFractalPingPong(FNfloat x, FNfloat y, FNfloat z)
+	float GenFractalPingPong(FNfloat x, FNfloat y, FNfloat z) const
 	{
 		int seed = mSeed;
 		float sum = 0;
@@ -958,7 +1514,7 @@ private:
 	// Simplex/OpenSimplex2 Noise
 
 	template <typename FNfloat>
-	float SingleSimplex(int seed, FNfloat x, FNfloat y)
+	float SingleSimplex(int seed, FNfloat x, FNfloat y) const
 	{
 		// 2D OpenSimplex2 case uses the same algorithm as ordinary Simplex.
 
@@ -1033,7 +1589,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float SingleOpenSimplex2(int seed, FNfloat x, FNfloat y, FNfloat z)
+	float SingleOpenSimplex2(int seed, FNfloat x, FNfloat y, FNfloat z) const
 	{
 		// 3D OpenSimplex2 case uses two offset rotated cube grids.
 
@@ -1135,7 +1691,7 @@ private:
 	// OpenSimplex2S Noise
 
 	template <typename FNfloat>
-	float SingleOpenSimplex2S(int seed, FNfloat x, FNfloat y)
+	float SingleOpenSimplex2S(int seed, FNfloat x, FNfloat y) const
 	{
 		// 2D OpenSimplex2S case is a modified 2D simplex noise.
 
@@ -1266,7 +1822,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float SingleOpenSimplex2S(int seed, FNfloat x, FNfloat y, FNfloat z)
+	float SingleOpenSimplex2S(int seed, FNfloat x, FNfloat y, FNfloat z) const
 	{
 		// 3D OpenSimplex2S case uses two offset rotated cube grids.
 
@@ -1447,7 +2003,7 @@ private:
 	// Cellular Noise
 
 	template <typename FNfloat>
-	float SingleCellular(int seed, FNfloat x, FNfloat y)
+	float SingleCellular(int seed, FNfloat x, FNfloat y) const
 	{
 		int xr = FastRound(x);
 		int yr = FastRound(y);
@@ -1577,7 +2133,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float SingleCellular(int seed, FNfloat x, FNfloat y, FNfloat z)
+	float SingleCellular(int seed, FNfloat x, FNfloat y, FNfloat z) const
 	{
 		int xr = FastRound(x);
 		int yr = FastRound(y);
@@ -1733,7 +2289,7 @@ private:
 	// Perlin Noise
 
 	template <typename FNfloat>
-	float SinglePerlin(int seed, FNfloat x, FNfloat y)
+	float SinglePerlin(int seed, FNfloat x, FNfloat y) const
 	{
 		int x0 = FastFloor(x);
 		int y0 = FastFloor(y);
@@ -1758,7 +2314,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float SinglePerlin(int seed, FNfloat x, FNfloat y, FNfloat z)
+	float SinglePerlin(int seed, FNfloat x, FNfloat y, FNfloat z) const
 	{
 		int x0 = FastFloor(x);
 		int y0 = FastFloor(y);
@@ -1796,7 +2352,7 @@ private:
 	// Value Cubic Noise
 
 	template <typename FNfloat>
-	float SingleValueCubic(int seed, FNfloat x, FNfloat y)
+	float SingleValueCubic(int seed, FNfloat x, FNfloat y) const
 	{
 		int x1 = FastFloor(x);
 		int y1 = FastFloor(y);
@@ -1827,7 +2383,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float SingleValueCubic(int seed, FNfloat x, FNfloat y, FNfloat z)
+	float SingleValueCubic(int seed, FNfloat x, FNfloat y, FNfloat z) const
 	{
 		int x1 = FastFloor(x);
 		int y1 = FastFloor(y);
@@ -1883,7 +2439,7 @@ private:
 	// Value Noise
 
 	template <typename FNfloat>
-	float SingleValue(int seed, FNfloat x, FNfloat y)
+	float SingleValue(int seed, FNfloat x, FNfloat y) const
 	{
 		int x0 = FastFloor(x);
 		int y0 = FastFloor(y);
@@ -1903,7 +2459,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	float SingleValue(int seed, FNfloat x, FNfloat y, FNfloat z)
+	float SingleValue(int seed, FNfloat x, FNfloat y, FNfloat z) const
 	{
 		int x0 = FastFloor(x);
 		int y0 = FastFloor(y);
@@ -1934,7 +2490,7 @@ private:
 	// Domain Warp
 
 	template <typename FNfloat>
-	void DoSingleDomainWarp(int seed, float amp, float freq, FNfloat x, FNfloat y, FNfloat &xr, FNfloat &yr)
+	void DoSingleDomainWarp(int seed, float amp, float freq, FNfloat x, FNfloat y, FNfloat &xr, FNfloat &yr) const
 	{
 		switch (mDomainWarpType)
 		{
@@ -1951,7 +2507,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void DoSingleDomainWarp(int seed, float amp, float freq, FNfloat x, FNfloat y, FNfloat z, FNfloat &xr, FNfloat &yr, FNfloat &zr)
+	void DoSingleDomainWarp(int seed, float amp, float freq, FNfloat x, FNfloat y, FNfloat z, FNfloat &xr, FNfloat &yr, FNfloat &zr) const
 	{
 		switch (mDomainWarpType)
 		{
@@ -1970,7 +2526,7 @@ private:
 	// Domain Warp Single Wrapper
 
 	template <typename FNfloat>
-	void DomainWarpSingle(FNfloat &x, FNfloat &y)
+	void DomainWarpSingle(FNfloat &x, FNfloat &y) const
 	{
 		int seed = mSeed;
 		float amp = mDomainWarpAmp * mFractalBounding;
@@ -1984,7 +2540,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void DomainWarpSingle(FNfloat &x, FNfloat &y, FNfloat &z)
+	void DomainWarpSingle(FNfloat &x, FNfloat &y, FNfloat &z) const
 	{
 		int seed = mSeed;
 		float amp = mDomainWarpAmp * mFractalBounding;
@@ -2001,7 +2557,7 @@ private:
 	// Domain Warp Fractal Progressive
 
 	template <typename FNfloat>
-	void DomainWarpFractalProgressive(FNfloat &x, FNfloat &y)
+	void DomainWarpFractalProgressive(FNfloat &x, FNfloat &y) const
 	{
 		int seed = mSeed;
 		float amp = mDomainWarpAmp * mFractalBounding;
@@ -2022,7 +2578,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void DomainWarpFractalProgressive(FNfloat &x, FNfloat &y, FNfloat &z)
+	void DomainWarpFractalProgressive(FNfloat &x, FNfloat &y, FNfloat &z) const
 	{
 		int seed = mSeed;
 		float amp = mDomainWarpAmp * mFractalBounding;
@@ -2046,7 +2602,7 @@ private:
 	// Domain Warp Fractal Independant
 
 	template <typename FNfloat>
-	void DomainWarpFractalIndependent(FNfloat &x, FNfloat &y)
+	void DomainWarpFractalIndependent(FNfloat &x, FNfloat &y) const
 	{
 		FNfloat xs = x;
 		FNfloat ys = y;
@@ -2067,7 +2623,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void DomainWarpFractalIndependent(FNfloat &x, FNfloat &y, FNfloat &z)
+	void DomainWarpFractalIndependent(FNfloat &x, FNfloat &y, FNfloat &z) const
 	{
 		FNfloat xs = x;
 		FNfloat ys = y;
@@ -2091,7 +2647,7 @@ private:
 	// Domain Warp Basic Grid
 
 	template <typename FNfloat>
-	void SingleDomainWarpBasicGrid(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat &xr, FNfloat &yr)
+	void SingleDomainWarpBasicGrid(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat &xr, FNfloat &yr) const
 	{
 		FNfloat xf = x * frequency;
 		FNfloat yf = y * frequency;
@@ -2124,7 +2680,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void SingleDomainWarpBasicGrid(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat z, FNfloat &xr, FNfloat &yr, FNfloat &zr)
+	void SingleDomainWarpBasicGrid(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat z, FNfloat &xr, FNfloat &yr, FNfloat &zr) const
 	{
 		FNfloat xf = x * frequency;
 		FNfloat yf = y * frequency;
@@ -2185,7 +2741,7 @@ private:
 	// Domain Warp Simplex/OpenSimplex2
 
 	template <typename FNfloat>
-	void SingleDomainWarpSimplexGradient(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat &xr, FNfloat &yr, bool outGradOnly)
+	void SingleDomainWarpSimplexGradient(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat &xr, FNfloat &yr, bool outGradOnly) const
 	{
 		const float SQRT3 = 1.7320508075688772935274463415059f;
 		const float G2 = (3 - SQRT3) / 6;
@@ -2283,7 +2839,7 @@ private:
 	}
 
 	template <typename FNfloat>
-	void SingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat z, FNfloat &xr, FNfloat &yr, FNfloat &zr, bool outGradOnly)
+	void SingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, float frequency, FNfloat x, FNfloat y, FNfloat z, FNfloat &xr, FNfloat &yr, FNfloat &zr, bool outGradOnly) const
 	{
 		x *= frequency;
 		y *= frequency;
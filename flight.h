@@ -0,0 +1,172 @@
+#ifndef FLIGHT_H
+#define FLIGHT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "benchmark.h"
+
+// --record/--replay file format: "GLFL", uint32 version, then one FlightRecord per
+// frame until the end of the file. little endian, written field by field without padding
+const char FLIGHT_MAGIC[4] = {'G', 'L', 'F', 'L'};
+const uint32_t FLIGHT_VERSION = 1;
+
+// held movement keys of a recorded frame
+enum FlightKey
+{
+	FLIGHT_KEY_FORWARD = 1,
+	FLIGHT_KEY_BACKWARD = 2,
+	FLIGHT_KEY_LEFT = 4,
+	FLIGHT_KEY_RIGHT = 8,
+	FLIGHT_KEY_UP = 16,
+	FLIGHT_KEY_DOWN = 32,
+	FLIGHT_KEY_FAST = 64
+};
+
+// camera state after a frame's input was applied, 26 bytes on disk
+struct FlightRecord
+{
+	float time; // seconds since the recording started
+	float position[3];
+	float yaw;
+	float pitch;
+	uint8_t keys; // FlightKey bits
+	uint8_t debugFlags; // ShaderFeature bits
+};
+
+const int FLIGHT_RECORD_SIZE = 26;
+
+// byte by byte, so recordings replay the same whatever the host's byte order
+inline void writeFlightWord(char *bytes, uint32_t word)
+{
+	for (int i = 0; i < 4; i++)
+		bytes[i] = (char)(word >> (8 * i));
+}
+
+inline uint32_t readFlightWord(const char *bytes)
+{
+	uint32_t word = 0;
+	for (int i = 0; i < 4; i++)
+		word |= (uint32_t)(uint8_t)bytes[i] << (8 * i);
+	return word;
+}
+
+inline void writeFlightFloat(char *bytes, float value)
+{
+	uint32_t word;
+	memcpy(&word, &value, 4);
+	writeFlightWord(bytes, word);
+}
+
+inline float readFlightFloat(const char *bytes)
+{
+	uint32_t word = readFlightWord(bytes);
+	float value;
+	memcpy(&value, &word, 4);
+	return value;
+}
+
+// streams live camera state to disk, one record per frame
+class FlightRecorder
+{
+private:
+	std::ofstream file;
+	long long frames = 0;
+
+public:
+	bool open(const std::string &filePath)
+	{
+		file.open(filePath, std::ios::binary);
+		if (!file)
+		{
+			std::cout << "ERROR::FLIGHT::CANNOT_WRITE: " << filePath << std::endl;
+			return false;
+		}
+
+		char version[4];
+		writeFlightWord(version, FLIGHT_VERSION);
+		file.write(FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC));
+		file.write(version, sizeof(version));
+		return true;
+	}
+
+	bool isOpen() const
+	{
+		return file.is_open();
+	}
+
+	void record(const FlightRecord &record)
+	{
+		char bytes[FLIGHT_RECORD_SIZE];
+		writeFlightFloat(bytes, record.time);
+		for (int i = 0; i < 3; i++)
+			writeFlightFloat(bytes + 4 + 4 * i, record.position[i]);
+		writeFlightFloat(bytes + 16, record.yaw);
+		writeFlightFloat(bytes + 20, record.pitch);
+		bytes[24] = record.keys;
+		bytes[25] = record.debugFlags;
+		file.write(bytes, FLIGHT_RECORD_SIZE);
+		frames++;
+	}
+
+	void close()
+	{
+		if (!file.is_open())
+			return;
+
+		file.close();
+		std::cout << "flight: recorded " << frames << " frames" << std::endl;
+	}
+};
+
+// reads a recording as a camera path, so replays go through the same fixed timestep
+// resampling as scripted benchmarks and don't depend on the recording's frame rate
+inline bool loadFlight(const std::string &filePath, CameraPath &path)
+{
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "ERROR::FLIGHT::FILE_NOT_SUCCESFULLY_READ: " << filePath << std::endl;
+		return false;
+	}
+
+	char magic[4];
+	char version[4];
+	file.read(magic, sizeof(magic));
+	file.read(version, sizeof(version));
+	if (!file || memcmp(magic, FLIGHT_MAGIC, sizeof(magic)) != 0 || readFlightWord(version) != FLIGHT_VERSION)
+	{
+		std::cout << "ERROR::FLIGHT::NOT_A_FLIGHT_RECORDING: " << filePath << std::endl;
+		return false;
+	}
+
+	path.clear();
+
+	char bytes[FLIGHT_RECORD_SIZE];
+	int fastFrames = 0;
+	while (file.read(bytes, FLIGHT_RECORD_SIZE))
+	{
+		FlightRecord record;
+		record.time = readFlightFloat(bytes);
+		for (int i = 0; i < 3; i++)
+			record.position[i] = readFlightFloat(bytes + 4 + 4 * i);
+		record.yaw = readFlightFloat(bytes + 16);
+		record.pitch = readFlightFloat(bytes + 20);
+		record.keys = bytes[24];
+		record.debugFlags = bytes[25];
+
+		if (record.keys & FLIGHT_KEY_FAST)
+			fastFrames++;
+
+		glm::vec3 position(record.position[0], record.position[1], record.position[2]);
+		path.add({record.time, position, record.yaw, record.pitch, record.debugFlags});
+	}
+
+	std::cout << "flight: " << filePath << ", " << path.duration() << "s, " << fastFrames << " sprint frames" << std::endl;
+	return path.duration() > 0.0f;
+}
+
+#endif
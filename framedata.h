@@ -0,0 +1,51 @@
+#ifndef FRAMEDATA_H
+#define FRAMEDATA_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "memstats.h"
+
+// GL_UNIFORM_BUFFER binding point of the FrameData block in every terrain shader
+const unsigned int FRAME_DATA_BINDING = 0;
+
+// mirrors the std140 FrameData block in shader.vs/shader.fs, members are
+// ordered so no std140 padding is needed besides the tail
+struct FrameData
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec4 lightPosition; // xyz, w unused
+	int debugFlags; // ShaderFeature bits of the active variant
+	int padding[3];
+};
+
+static_assert(sizeof(FrameData) == 160, "FrameData must match the std140 layout");
+
+// per-frame state shared by all shaders, uploaded once per frame
+class FrameUniforms
+{
+private:
+	unsigned int UBO = 0;
+
+public:
+	FrameData data = {};
+
+	void init()
+	{
+		glGenBuffers(1, &UBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+		memoryAccounting().allocateGpu(GPU_MEMORY_UNIFORMS, sizeof(FrameData));
+		glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, UBO);
+	}
+
+	void upload()
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+	}
+};
+
+#endif
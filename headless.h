@@ -0,0 +1,130 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// offscreen GL context for running without a window (CI, batch hosts, Mesa llvmpipe).
+// needs EGL: build with -DGLTERRAIN_EGL and link -lEGL, otherwise initHeadless() fails
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "memstats.h"
+
+#ifdef GLTERRAIN_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+class HeadlessContext
+{
+private:
+	unsigned int FBO = 0;
+	unsigned int colorBuffer = 0;
+	unsigned int depthBuffer = 0;
+
+#ifdef GLTERRAIN_EGL
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+
+	// surfaceless Mesa first, then whatever the default display is
+	EGLDisplay openDisplay()
+	{
+		auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+		{
+			EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+			if (surfaceless != EGL_NO_DISPLAY && eglInitialize(surfaceless, NULL, NULL))
+				return surfaceless;
+		}
+
+		EGLDisplay fallback = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (fallback != EGL_NO_DISPLAY && eglInitialize(fallback, NULL, NULL))
+			return fallback;
+
+		return EGL_NO_DISPLAY;
+	}
+#endif
+
+public:
+	// creates the context and a width x height framebuffer to render into
+	int init(int width, int height)
+	{
+#ifdef GLTERRAIN_EGL
+		display = openDisplay();
+		if (display == EGL_NO_DISPLAY)
+		{
+			std::cout << "Failed to init EGL display" << std::endl;
+			return -1;
+		}
+
+		eglBindAPI(EGL_OPENGL_API);
+
+		// same core 3.3 request as the window, drivers hand out their newest core version
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 3,
+			EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE};
+
+		// no config and no surface, everything is drawn into the FBO below
+		context = eglCreateContext(display, (EGLConfig)0, EGL_NO_CONTEXT, contextAttributes);
+		if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+		{
+			std::cout << "Failed to create EGL context" << std::endl;
+			return -1;
+		}
+
+		if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+		{
+			std::cout << "Failed to initialize GLAD" << std::endl;
+			return -1;
+		}
+
+		glGenFramebuffers(1, &FBO);
+		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+
+		glGenRenderbuffers(1, &colorBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+		glGenRenderbuffers(1, &depthBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+		// RGBA8 and D24S8 are 4 bytes per pixel each
+		memoryAccounting().allocateGpu(GPU_MEMORY_FRAMEBUFFER, 2 * (size_t)width * height * 4);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "Failed to create offscreen framebuffer" << std::endl;
+			return -1;
+		}
+
+		std::cout << "headless: " << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+		return 0;
+#else
+		(void)width;
+		(void)height;
+		std::cout << "Headless mode needs a build with -DGLTERRAIN_EGL" << std::endl;
+		return -1;
+#endif
+	}
+
+	void terminate()
+	{
+#ifdef GLTERRAIN_EGL
+		if (display == EGL_NO_DISPLAY)
+			return;
+
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (context != EGL_NO_CONTEXT)
+			eglDestroyContext(display, context);
+		eglTerminate(display);
+		display = EGL_NO_DISPLAY;
+#endif
+	}
+};
+
+#endif
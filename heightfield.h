@@ -0,0 +1,170 @@
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "computeshader.h"
+#include "fastnoise.h"
+#include "memstats.h"
+
+// max difference between GPU and CPU heights, in world units (NOISE_SCALE 64).
+// both sides run the same float ops, the slack covers fused multiply-adds on the GPU
+const float HEIGHTFIELD_TOLERANCE = 1e-3f;
+// max difference between the normalized GPU and CPU normals
+const float HEIGHTFIELD_NORMAL_TOLERANCE = 1e-2f;
+
+// generates the terrain grid with heightfield.comp straight into vertex buffers
+class GpuHeightfield
+{
+private:
+	ComputeShader computeShader;
+
+	int size = 0;
+	int originLocation = -1;
+
+	unsigned int VAO = 0;
+	unsigned int positionBuffer = 0;
+	unsigned int normalBuffer = 0;
+	unsigned int gradientBuffer = 0;
+	unsigned int EBO = 0;
+
+	bool ready = false;
+
+public:
+	GpuHeightfield(const char *computePath) : computeShader(computePath) {}
+
+	// compute needs GL 4.3, and only the Perlin kernel is ported
+	static bool supports(const FastNoiseLite &noise)
+	{
+		if (!GLAD_GL_VERSION_4_3)
+			return false;
+
+		if (noise.GetNoiseType() != FastNoiseLite::NoiseType_Perlin)
+			return false;
+
+		switch (noise.GetFractalType())
+		{
+		case FastNoiseLite::FractalType_None:
+		case FastNoiseLite::FractalType_FBm:
+		case FastNoiseLite::FractalType_Ridged:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// returns false if the CPU path has to be used instead
+	bool init(const FastNoiseLite &noise, int size, float heightScale, float normalEpsilon)
+	{
+		if (!supports(noise) || !computeShader.compile())
+			return false;
+
+		this->size = size;
+
+		computeShader.use();
+		originLocation = computeShader.getUniformLocation("origin");
+		computeShader.setInt("size", size);
+		computeShader.setFloat("heightScale", heightScale);
+		computeShader.setFloat("normalEpsilon", normalEpsilon);
+
+		computeShader.setInt("seed", noise.GetSeed());
+		computeShader.setFloat("frequency", noise.GetFrequency());
+		computeShader.setInt("fractalType", noise.GetFractalType());
+		computeShader.setInt("octaves", noise.GetFractalOctaves());
+		computeShader.setFloat("lacunarity", noise.GetFractalLacunarity());
+		computeShader.setFloat("gain", noise.GetFractalGain());
+		computeShader.setFloat("weightedStrength", noise.GetFractalWeightedStrength());
+		computeShader.setFloat("fractalBounding", noise.GetFractalBounding());
+
+		glGenBuffers(1, &gradientBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, gradientBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, 256 * sizeof(float), FastNoiseLite::GetGradients2D(), GL_STATIC_DRAW);
+		memoryAccounting().allocateGpu(GPU_MEMORY_NOISE_TABLES, 256 * sizeof(float));
+
+		glGenVertexArrays(1, &VAO);
+		glBindVertexArray(VAO);
+
+		// positions and normals are vec4 in the storage buffers, the shaders read xyz
+		glGenBuffers(1, &positionBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+		glBufferData(GL_ARRAY_BUFFER, size * size * 4 * sizeof(float), NULL, GL_DYNAMIC_COPY);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 4, (void *)0);
+		glEnableVertexAttribArray(0);
+
+		glGenBuffers(1, &normalBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, normalBuffer);
+		glBufferData(GL_ARRAY_BUFFER, size * size * 4 * sizeof(float), NULL, GL_DYNAMIC_COPY);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 4, (void *)0);
+		glEnableVertexAttribArray(1);
+		memoryAccounting().allocateGpu(GPU_MEMORY_TERRAIN_VERTICES, 2 * size * size * 4 * sizeof(float));
+
+		// the grid topology never changes, only the heights do
+		std::vector<unsigned int> indices;
+		for (int i = 0; i < size - 1; i++)
+		{
+			for (int j = 0; j < size - 1; j++)
+			{
+				indices.push_back(size * i + j);
+				indices.push_back(size * i + j + 1);
+				indices.push_back(size * (i + 1) + j);
+
+				indices.push_back(size * (i + 1) + j);
+				indices.push_back(size * i + j + 1);
+				indices.push_back(size * (i + 1) + j + 1);
+			}
+		}
+
+		glGenBuffers(1, &EBO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		memoryAccounting().allocateGpu(GPU_MEMORY_TERRAIN_INDICES, indices.size() * sizeof(unsigned int));
+
+		glBindVertexArray(0);
+
+		ready = true;
+		return true;
+	}
+
+	bool isReady()
+	{
+		return ready;
+	}
+
+	// fills the grid whose first vertex sits at (originX, originZ). leaves the compute program bound
+	void generate(int originX, int originZ)
+	{
+		computeShader.use();
+		computeShader.setIVec2(originLocation, originX, originZ);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, positionBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, normalBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, gradientBuffer);
+
+		glDispatchCompute((size + 7) / 8, (size + 7) / 8, 1);
+		glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	}
+
+	// expects the terrain shader to be bound
+	void draw()
+	{
+		glBindVertexArray(VAO);
+		glDrawElements(GL_TRIANGLES, (size - 1) * (size - 1) * 6, GL_UNSIGNED_INT, 0);
+		glBindVertexArray(0);
+	}
+
+	// copies the last generated grid back, 4 floats per vertex
+	void readback(std::vector<float> &positions, std::vector<float> &normals)
+	{
+		positions.resize(size * size * 4);
+		normals.resize(size * size * 4);
+
+		glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, positions.size() * sizeof(float), &positions[0]);
+		glBindBuffer(GL_ARRAY_BUFFER, normalBuffer);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, normals.size() * sizeof(float), &normals[0]);
+	}
+};
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef LAYEREDNOISE_H
+#define LAYEREDNOISE_H
+
+// fractal noise in two layers: the first octaves on a coarse lattice, cached in tiles
+// shared by every chunk and reconstructed with Catmull-Rom splines, plus the remaining
+// octaves evaluated at full resolution. the lattice keeps each octave's raw noise, which
+// is smooth, and the fractal (ridges, ping pong, weighting) is applied after the
+// interpolation. init() measures how many octaves fit in an error bound
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "fastnoise.h"
+#include "memstats.h"
+#include "noisedispatch.h"
+
+const int LAYERED_TILE_SIZE = 32; // lattice points per tile side
+const int LAYERED_MAX_TILES = 256; // the oldest tiles are dropped beyond this, 4 KB per octave each
+const int LAYERED_CALIBRATION_SAMPLES = 1024; // the bound holds for these, not everywhere
+const float LAYERED_CALIBRATION_RANGE = 2048.0f; // calibration points in -range...range
+
+// the raw noise of every coarse octave, octave by octave, rows of LAYERED_TILE_SIZE
+typedef TrackedVector<float, MEMORY_CHUNK_CACHE> LayeredTile;
+
+class LayeredNoise
+{
+private:
+	const FastNoiseLite *noise = NULL;
+	const NoiseDispatch *dispatch = NULL;
+
+	float spacing = 4.0f;
+	int octaves = 1;
+	int coarseOctaves = 0;
+	float measuredError = 0.0f;
+
+	// without weighted strength the fine octaves start at the same amplitude everywhere
+	bool weighted = false;
+	float fineAmp = 0.0f;
+
+	std::unordered_map<long long, LayeredTile> tiles;
+	std::deque<long long> tileOrder;
+
+	std::vector<float> patch; // lattice under the last grid, octave by row by column
+	std::vector<float> rowLayers; // coarse octave by lattice column, blended vertically
+	std::vector<float> columnWeights;
+	std::vector<int> columnOffsets;
+	std::vector<float> amps; // amplitude of the first fine octave per sample
+	std::vector<float> fine;
+
+	static int floorDiv(int a, int b)
+	{
+		return a >= 0 ? a / b : -((-a + b - 1) / b);
+	}
+
+	static void catmullRom(float t, float weights[4])
+	{
+		weights[0] = ((-t + 2) * t - 1) * t * 0.5f;
+		weights[1] = ((3 * t - 5) * t * t + 2) * 0.5f;
+		weights[2] = ((-3 * t + 4) * t + 1) * t * 0.5f;
+		weights[3] = (t - 1) * t * t * 0.5f;
+	}
+
+	const LayeredTile &tile(int tx, int ty)
+	{
+		long long key = (long long)tx << 32 | (unsigned int)ty;
+		auto found = tiles.find(key);
+		if (found != tiles.end())
+			return found->second;
+
+		if ((int)tiles.size() >= LAYERED_MAX_TILES)
+		{
+			tiles.erase(tileOrder.front());
+			tileOrder.pop_front();
+		}
+
+		LayeredTile &created = tiles[key];
+		tileOrder.push_back(key);
+
+		const int points = LAYERED_TILE_SIZE * LAYERED_TILE_SIZE;
+		created.resize(coarseOctaves * points);
+		for (int octave = 0; octave < coarseOctaves; octave++)
+		{
+			for (int j = 0; j < LAYERED_TILE_SIZE; j++)
+			{
+				float y = (ty * LAYERED_TILE_SIZE + j) * spacing;
+				for (int i = 0; i < LAYERED_TILE_SIZE; i++)
+					created[octave * points + j * LAYERED_TILE_SIZE + i] = noise->GetNoiseOctave((tx * LAYERED_TILE_SIZE + i) * spacing, y, octave);
+			}
+		}
+
+		return created;
+	}
+
+	// raw noise of a coarse octave at lattice point (ix, iy), calibration goes around the cache
+	float latticePoint(int ix, int iy, int octave, bool cached)
+	{
+		if (!cached)
+			return noise->GetNoiseOctave(ix * spacing, iy * spacing, octave);
+
+		int tx = floorDiv(ix, LAYERED_TILE_SIZE);
+		int ty = floorDiv(iy, LAYERED_TILE_SIZE);
+		int index = (iy - ty * LAYERED_TILE_SIZE) * LAYERED_TILE_SIZE + ix - tx * LAYERED_TILE_SIZE;
+		return tile(tx, ty)[octave * LAYERED_TILE_SIZE * LAYERED_TILE_SIZE + index];
+	}
+
+	// copies the lattice points columnStart... by rowStart... of every coarse octave into patch
+	void gather(int columnStart, int rowStart, int columns, int rows)
+	{
+		patch.resize(coarseOctaves * rows * columns);
+		for (int ty = floorDiv(rowStart, LAYERED_TILE_SIZE); ty * LAYERED_TILE_SIZE < rowStart + rows; ty++)
+		{
+			for (int tx = floorDiv(columnStart, LAYERED_TILE_SIZE); tx * LAYERED_TILE_SIZE < columnStart + columns; tx++)
+			{
+				const LayeredTile &source = tile(tx, ty);
+				int i0 = std::max(columnStart, tx * LAYERED_TILE_SIZE);
+				int i1 = std::min(columnStart + columns, (tx + 1) * LAYERED_TILE_SIZE);
+				int j0 = std::max(rowStart, ty * LAYERED_TILE_SIZE);
+				int j1 = std::min(rowStart + rows, (ty + 1) * LAYERED_TILE_SIZE);
+
+				for (int octave = 0; octave < coarseOctaves; octave++)
+					for (int j = j0; j < j1; j++)
+						std::copy_n(&source[(octave * LAYERED_TILE_SIZE + j - ty * LAYERED_TILE_SIZE) * LAYERED_TILE_SIZE + i0 - tx * LAYERED_TILE_SIZE],
+									i1 - i0, &patch[(octave * rows + j - rowStart) * columns + i0 - columnStart]);
+			}
+		}
+	}
+
+	float sample(float x, float y, bool cached)
+	{
+		float gx = x / spacing;
+		float gy = y / spacing;
+		int ix = (int)floorf(gx);
+		int iy = (int)floorf(gy);
+
+		float wx[4], wy[4];
+		catmullRom(gx - ix, wx);
+		catmullRom(gy - iy, wy);
+
+		float sum = 0.0f;
+		float amp = noise->GetFractalBounding();
+		for (int octave = 0; octave < coarseOctaves; octave++)
+		{
+			float value = 0.0f;
+			for (int j = 0; j < 4; j++)
+				for (int i = 0; i < 4; i++)
+					value += wx[i] * wy[j] * latticePoint(ix - 1 + i, iy - 1 + j, octave, cached);
+			noise->AddOctave(value, sum, amp);
+		}
+
+		return sum + noise->GetNoiseOctaves(x, y, coarseOctaves, octaves, amp);
+	}
+
+	// largest difference to GetNoise over a fixed set of points
+	float measureError()
+	{
+		unsigned int seed = 1;
+		auto coordinate = [&]() {
+			seed = seed * 1664525u + 1013904223u;
+			return ((seed >> 8) / 16777216.0f * 2.0f - 1.0f) * LAYERED_CALIBRATION_RANGE;
+		};
+
+		float error = 0.0f;
+		for (int i = 0; i < LAYERED_CALIBRATION_SAMPLES; i++)
+		{
+			float x = coordinate();
+			float y = coordinate();
+			error = std::fmax(error, std::fabs(sample(x, y, false) - noise->GetNoise(x, y)));
+		}
+		return error;
+	}
+
+public:
+	// measures how many leading octaves of noise a lattice spacing world units apart can
+	// take with an error of at most maxError, call again after changing the noise settings.
+	// dispatch, if given, evaluates the fine octaves with the vectorized kernels
+	int init(const FastNoiseLite &noise, const NoiseDispatch *dispatch, float spacing, float maxError)
+	{
+		this->noise = &noise;
+		this->dispatch = dispatch;
+		this->spacing = spacing;
+		clear();
+
+		FastNoiseLite::FractalType fractalType = noise.GetFractalType();
+		bool fractal = fractalType == FastNoiseLite::FractalType_FBm || fractalType == FastNoiseLite::FractalType_Ridged ||
+					   fractalType == FastNoiseLite::FractalType_PingPong;
+		octaves = fractal ? noise.GetFractalOctaves() : 1;
+		weighted = noise.GetFractalWeightedStrength() != 0.0f;
+
+		// the error grows with every octave moved to the lattice, stop at the first one over the bound
+		coarseOctaves = 0;
+		measuredError = 0.0f;
+		for (int count = 1; count <= octaves; count++)
+		{
+			coarseOctaves = count;
+			float error = measureError();
+			if (error > maxError)
+			{
+				coarseOctaves = count - 1;
+				break;
+			}
+			measuredError = error;
+		}
+
+		// every octave without weighted strength scales the amplitude by the gain
+		fineAmp = noise.GetFractalBounding();
+		for (int i = 0; i < coarseOctaves; i++)
+			fineAmp *= noise.GetFractalGain();
+
+		std::cout << "layered noise: " << coarseOctaves << " of " << octaves << " octaves on a " << spacing
+				  << " unit lattice, max error " << measuredError << " (bound " << maxError << ")" << std::endl;
+		return coarseOctaves;
+	}
+
+	int getCoarseOctaves() const
+	{
+		return coarseOctaves;
+	}
+
+	float getMeasuredError() const
+	{
+		return measuredError;
+	}
+
+	int getTileCount() const
+	{
+		return tiles.size();
+	}
+
+	// drops the cached lattice
+	void clear()
+	{
+		tiles.clear();
+		tileOrder.clear();
+	}
+
+	float getNoise(float x, float y)
+	{
+		return sample(x, y, true);
+	}
+
+	// same layout and coordinates as FastNoiseLite::GetNoiseGrid
+	void getNoiseGrid(float xStart, float yStart, float step, int width, int height, float *out)
+	{
+		// the lattice points any sample touches, copied out of the tiles once
+		int columnStart = (int)floorf(std::fmin(xStart, xStart + (width - 1) * step) / spacing) - 1;
+		int columnEnd = (int)floorf(std::fmax(xStart, xStart + (width - 1) * step) / spacing) + 2;
+		int rowStart = (int)floorf(std::fmin(yStart, yStart + (height - 1) * step) / spacing) - 1;
+		int rowEnd = (int)floorf(std::fmax(yStart, yStart + (height - 1) * step) / spacing) + 2;
+		int columns = columnEnd - columnStart + 1;
+		int rows = rowEnd - rowStart + 1;
+		gather(columnStart, rowStart, columns, rows);
+
+		rowLayers.resize(coarseOctaves * columns);
+		amps.resize(width * height);
+
+		// the horizontal weights are the same for every row
+		columnWeights.resize(width * 4);
+		columnOffsets.resize(width);
+		for (int x = 0; x < width; x++)
+		{
+			float gx = (xStart + x * step) / spacing;
+			int ix = (int)floorf(gx);
+			catmullRom(gx - ix, &columnWeights[x * 4]);
+			columnOffsets[x] = ix - 1 - columnStart;
+		}
+
+		// coarse layer, each octave blended vertically once per row and lattice column,
+		// then across for every sample and put through the fractal
+		for (int row = 0; row < height; row++)
+		{
+			float gy = (yStart + row * step) / spacing;
+			int iy = (int)floorf(gy);
+			float wy[4];
+			catmullRom(gy - iy, wy);
+
+			for (int octave = 0; octave < coarseOctaves; octave++)
+			{
+				const float *lattice = &patch[(octave * rows + iy - 1 - rowStart) * columns];
+				float *layer = &rowLayers[octave * columns];
+				for (int column = 0; column < columns; column++)
+					layer[column] = wy[0] * lattice[column] + wy[1] * lattice[columns + column] +
+									wy[2] * lattice[2 * columns + column] + wy[3] * lattice[3 * columns + column];
+			}
+
+			for (int x = 0; x < width; x++)
+			{
+				const float *wx = &columnWeights[x * 4];
+				float sum = 0.0f;
+				float amp = noise->GetFractalBounding();
+				for (int octave = 0; octave < coarseOctaves; octave++)
+				{
+					const float *layer = &rowLayers[octave * columns + columnOffsets[x]];
+					noise->AddOctave(wx[0] * layer[0] + wx[1] * layer[1] + wx[2] * layer[2] + wx[3] * layer[3], sum, amp);
+				}
+
+				out[row * width + x] = sum;
+				amps[row * width + x] = amp;
+			}
+		}
+
+		if (coarseOctaves == octaves)
+			return;
+
+		// fine layer. without weighted strength the fine octaves are a fractal of their own,
+		// with seed, frequency and amplitude moved on by coarseOctaves
+		NoiseGridKernel gridKernel = dispatch && !weighted ? dispatch->kernel(*noise) : NULL;
+		if (gridKernel)
+		{
+			NoiseKernelParams params = NoiseDispatch::kernelParams(*noise, (float)(octaves - coarseOctaves));
+			params.seed += coarseOctaves;
+			for (int i = 0; i < coarseOctaves; i++)
+				params.frequency *= params.lacunarity;
+			params.octaves = octaves - coarseOctaves;
+			params.bounding = fineAmp;
+
+			fine.resize(width * height);
+			gridKernel(params, xStart, yStart, step, width, height, &fine[0]);
+			for (int i = 0; i < width * height; i++)
+				out[i] += fine[i];
+			return;
+		}
+
+		for (int row = 0; row < height; row++)
+		{
+			float y = yStart + row * step;
+			for (int x = 0; x < width; x++)
+				out[row * width + x] += noise->GetNoiseOctaves(xStart + x * step, y, coarseOctaves, octaves, amps[row * width + x]);
+		}
+	}
+};
+
+#endif
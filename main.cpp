@@ -3,14 +3,35 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "shader.h"
+#include "shadervariants.h"
 #include "camera.h"
 #include "fastnoise.h"
+#include "noiseconfig.h"
+#include "noisedispatch.h"
+#include "layerednoise.h"
+#include "noiselayers.h"
+#include "noisegraph.h"
+#include "heightfield.h"
+#include "framedata.h"
+#include "materials.h"
+#include "headless.h"
+#include "benchmark.h"
+#include "png.h"
+#include "profiler.h"
+#include "flight.h"
+#include "memstats.h"
 
 const int DEFAULT_WIDTH = 1920;
 const int DEFAULT_HEIGHT = 1080;
@@ -22,9 +43,19 @@ const float DIFFUSE_EPSILON = 0.01f;
 const float OCTAVES = 6;
 const float NOISE_SCALE = 64;
 
+// --warp amp: BasicGrid domain warp, the one with vectorized kernels
+const float WARP_FREQUENCY = 0.005f;
+const int WARP_OCTAVES = 3;
+
+const float TUNE_GAIN_STEP = 0.05f;
+const float TUNE_WEIGHTED_STEP = 0.1f;
+
 const float CAMERA_SPEED_DEFAULT = 15.0f;
 const float CAMERA_SPEED_FAST = 150.0f;
 
+// replays run at 60 simulated frames per second of the recording
+const float REPLAY_TIMESTEP = 1.0f / 60.0f;
+
 // struct later
 const float skyR = 0.0f;
 const float skyG = 135.0f / 255.0f;
@@ -39,38 +70,313 @@ float lastY;
 float firstMouse = true;
 
 Camera mainCamera(glm::vec3(0.0f, 10.0f, 3.0f), CAMERA_SPEED_DEFAULT);
-FastNoiseLite noise;
-Shader shader("shader.vs", "shader.fs");
+// frozen, replaced as a whole through noise.edit()
+NoiseConfig noise;
+ShaderVariants shaders("shader.vs", "shader.fs");
+Shader *activeShader;
+GpuHeightfield heightfield("heightfield.comp");
+FrameUniforms frameUniforms;
+MaterialRamp materialRamp;
+Profiler profiler;
+
+// vectorized CPU noise, --noise-isa scalar|sse2|avx2|avx512 forces a narrower instruction set
+NoiseDispatch noiseDispatch;
+std::string noiseIsa;
+
+// --layered spacing: the first octaves on a cached lattice spacing units apart, as many as
+// stay within --layered-error of the full noise (before NOISE_SCALE)
+LayeredNoise layeredNoise;
+float layeredSpacing = 0.0f;
+float layeredError = 0.002f;
+
+// --tune-noise: 1/2 octaves, 3/4 gain, 5/6 weighted strength on the CPU terrain, which
+// keeps every octave of the last grid and only recombines them after a change
+bool tuneNoise = false;
+bool tuneKeyDown = false;
+NoiseLayers noiseLayers;
+
+// --warp amp: warp the terrain by up to amp units, replaces --layered and --tune-noise
+NoiseConfig warp;
+float warpAmp = 0.0f;
+
+// --noise-graph file: the terrain from a noise graph, see terrain.noise. replaces --warp,
+// --layered and --tune-noise
+NoiseGraph noiseGraph;
+std::string noiseGraphFile;
+
+// --gpu: generate the terrain with heightfield.comp, falls back to the CPU if unsupported
+bool gpuTerrain = false;
+
+// --headless: render offscreen through EGL instead of a window, implies --benchmark
+bool headless = false;
+// --benchmark: fly mainCamera along a scripted path with vsync off and report frame times
+bool benchmark = false;
+int benchmarkFrames = 600; // --frames N
+bool benchmarkFramesSet = false;
+std::string cameraPathFile; // --path file, see CameraPath::load
+std::string captureDir; // --capture dir, writes PNG frames
+int captureInterval = 60; // --capture-every N
+std::string resultsFile; // --results file.json
+std::string timingsFile; // --timings file.csv, per-frame times along the path
+
+// --stress: fly every pattern at every speed and count frames over the budget
+bool stress = false;
+std::vector<float> stressSpeeds = STRESS_SPEEDS_DEFAULT; // --speeds 15,150,1000
+float stressSeconds = 2.0f; // --stress-seconds N, per pattern and speed
+double hitchBudget = 1000.0 / 60.0; // --budget ms
+
+// grid origin of the last drawn terrain, see terrainReady()
+int terrainOriginX = 0;
+int terrainOriginZ = 0;
+
+// --record file: log the live camera every frame, --replay file: benchmark along a recording
+std::string replayFile;
+FlightRecorder flightRecorder;
+float recordTime = 0.0f;
+
+// --profile name: dump the profiler to name.csv/name.json on exit, P dumps at any time
+std::string profileName = "profile";
+bool profileOnExit = false;
+bool profileKeyDown = false;
+
+// --perf-counters: count hardware events per profiler stage through perf_event_open
+bool perfCounters = false;
+
+// --trace file.json: write the trace spans on exit, needs a build with -DGLTERRAIN_TRACE
+std::string traceFile;
 
 GLFWwindow *window;
+HeadlessContext headlessContext;
 
 int initWindow();
 int gladInit();
+void terminateContext();
 void processInputs();
+void tuneFractal(int key);
+void drawFrame();
 void render();
+void renderGpu();
+int verifyGpuHeightfield();
+int runBenchmark();
+int runStressBenchmark();
+double drawBenchmarkFrame(const CameraKeyframe &keyframe, float timestep);
+bool terrainReady();
+void captureFrame(int frame);
+void recordFlight();
+
+float terrainHeight(float worldX, float worldZ);
+glm::vec3 terrainNormal(float worldX, float worldZ);
+glm::vec3 terrainNormal(float left, float right, float back, float front);
 
 void frame_buffer_size_callback(GLFWwindow *, int, int);
 void cursor_position_callback(GLFWwindow *, double, double);
 
-int main()
+int main(int argc, char **argv)
 {
-	initWindow();
-	noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-	noise.SetFractalType(FastNoiseLite::FractalType_Ridged);
-	noise.SetFractalOctaves(OCTAVES);
+	bool verifyGpu = false;
+	for (int i = 1; i < argc; i++)
+	{
+		// value of an option like --frames N
+		auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : ""; };
+
+		if (strcmp(argv[i], "--gpu") == 0)
+			gpuTerrain = true;
+		else if (strcmp(argv[i], "--verify-gpu") == 0)
+			verifyGpu = true;
+		else if (strcmp(argv[i], "--headless") == 0)
+			headless = benchmark = true;
+		else if (strcmp(argv[i], "--benchmark") == 0)
+			benchmark = true;
+		else if (strcmp(argv[i], "--frames") == 0)
+		{
+			benchmarkFrames = atoi(value());
+			benchmarkFramesSet = true;
+			if (benchmarkFrames < 1)
+			{
+				std::cout << "--frames needs a count of at least 1" << std::endl;
+				return -1;
+			}
+		}
+		else if (strcmp(argv[i], "--path") == 0)
+			cameraPathFile = value();
+		else if (strcmp(argv[i], "--capture") == 0)
+			captureDir = value();
+		else if (strcmp(argv[i], "--capture-every") == 0)
+			captureInterval = atoi(value());
+		else if (strcmp(argv[i], "--results") == 0)
+			resultsFile = value();
+		else if (strcmp(argv[i], "--timings") == 0)
+			timingsFile = value();
+		else if (strcmp(argv[i], "--stress") == 0)
+			stress = benchmark = true;
+		else if (strcmp(argv[i], "--stress-seconds") == 0)
+			stressSeconds = atof(value());
+		else if (strcmp(argv[i], "--budget") == 0)
+			hitchBudget = atof(value());
+		else if (strcmp(argv[i], "--speeds") == 0)
+		{
+			stressSpeeds.clear();
+			std::istringstream speeds(value());
+			std::string speed;
+			while (std::getline(speeds, speed, ','))
+				stressSpeeds.push_back(atof(speed.c_str()));
+		}
+		else if (strcmp(argv[i], "--record") == 0)
+		{
+			if (!flightRecorder.open(value()))
+				return -1;
+		}
+		else if (strcmp(argv[i], "--replay") == 0)
+		{
+			replayFile = value();
+			benchmark = true;
+		}
+		else if (strcmp(argv[i], "--profile") == 0)
+		{
+			profileName = value();
+			profileOnExit = true;
+		}
+		else if (strcmp(argv[i], "--noise-isa") == 0)
+			noiseIsa = value();
+		else if (strcmp(argv[i], "--layered") == 0)
+			layeredSpacing = atof(value());
+		else if (strcmp(argv[i], "--layered-error") == 0)
+			layeredError = atof(value());
+		else if (strcmp(argv[i], "--tune-noise") == 0)
+			tuneNoise = true;
+		else if (strcmp(argv[i], "--warp") == 0)
+			warpAmp = atof(value());
+		else if (strcmp(argv[i], "--noise-graph") == 0)
+			noiseGraphFile = value();
+		else if (strcmp(argv[i], "--perf-counters") == 0)
+			perfCounters = true;
+		else if (strcmp(argv[i], "--trace") == 0)
+		{
+			traceFile = value();
+			if (!TRACE_ENABLED)
+				std::cout << "Tracing needs a build with -DGLTERRAIN_TRACE" << std::endl;
+		}
+		else
+			std::cout << "Unknown option " << argv[i] << std::endl;
+	}
+
+	TRACE_THREAD_NAME("main");
+
+	if (headless)
+	{
+		if (headlessContext.init(DEFAULT_WIDTH, DEFAULT_HEIGHT) != 0)
+			return -1;
+
+		glViewport(0, 0, DEFAULT_WIDTH, DEFAULT_HEIGHT);
+		glEnable(GL_DEPTH_TEST);
+	}
+	else if (initWindow() != 0)
+	{
+		return -1;
+	}
+
+	noise = NoiseConfigBuilder()
+				.noiseType(FastNoiseLite::NoiseType_Perlin)
+				.fractalType(FastNoiseLite::FractalType_Ridged)
+				.fractalOctaves(OCTAVES)
+				.build();
+	memoryAccounting().allocate(MEMORY_NOISE_TABLES, FastNoiseLite::GetLookupTableSize());
+
+	noiseDispatch.init(noiseIsa);
+	noiseDispatch.describe(noise.get());
+	if (layeredSpacing > 0.0f)
+		layeredNoise.init(noise.get(), &noiseDispatch, layeredSpacing, layeredError);
 
-	shader.compile();
-	shader.use();
+	if (warpAmp > 0.0f)
+	{
+		warp = NoiseConfigBuilder()
+				   .frequency(WARP_FREQUENCY)
+				   .domainWarpType(FastNoiseLite::DomainWarpType_BasicGrid)
+				   .domainWarpAmp(warpAmp)
+				   .fractalType(FastNoiseLite::FractalType_DomainWarpProgressive)
+				   .fractalOctaves(WARP_OCTAVES)
+				   .build();
+
+		if (verifyGpu)
+		{
+			std::cout << "The GPU heightfield has no domain warp to verify" << std::endl;
+			terminateContext();
+			return -1;
+		}
+		if (gpuTerrain)
+			std::cout << "GPU terrain has no domain warp, using the CPU path" << std::endl;
+		gpuTerrain = false;
+	}
+
+	if (!noiseGraphFile.empty())
+	{
+		if (!noiseGraph.load(noiseGraphFile))
+		{
+			terminateContext();
+			return -1;
+		}
+
+		if (verifyGpu)
+		{
+			std::cout << "The GPU heightfield has no noise graph to verify" << std::endl;
+			terminateContext();
+			return -1;
+		}
+		if (gpuTerrain)
+			std::cout << "GPU terrain has no noise graph, using the CPU path" << std::endl;
+		gpuTerrain = false;
+	}
+
+	if (gpuTerrain || verifyGpu)
+	{
+		if (!heightfield.init(noise.get(), RENDER_DISTANCE, NOISE_SCALE, DIFFUSE_EPSILON))
+		{
+			std::cout << "GPU terrain unavailable, using the CPU path" << std::endl;
+			gpuTerrain = false;
+		}
+	}
+
+	if (verifyGpu)
+	{
+		int result = verifyGpuHeightfield();
+		terminateContext();
+		return result;
+	}
+
+	shaders.compileAll();
+
+	frameUniforms.init();
+	profiler.init();
+	if (perfCounters && !profiler.initCounters())
+		std::cout << "perf counters unavailable, reporting timings only" << std::endl;
+
+	// the ridged noise stays within -1...1
+	materialRamp.init(-NOISE_SCALE, NOISE_SCALE);
+	materialRamp.update(DEFAULT_MATERIALS);
+	materialRamp.bind(0);
 
 	glm::mat4 model = glm::mat4(1.0f);
 
-	glm::mat4 view = glm::mat4(1.0f);
+	for (int features = 0; features < shaders.count(); features++)
+	{
+		Shader &variant = shaders.use(features);
+		variant.bindUniformBlock("FrameData", FRAME_DATA_BINDING);
+		variant.setMat4("model", model);
+		variant.setInt("materialRamp", 0);
+		variant.setVec2("materialRange", materialRamp.getRange());
+	}
+
+	frameUniforms.data.projection = glm::perspective(45.0f, (float)DEFAULT_WIDTH / DEFAULT_HEIGHT, 0.1f, FAR_PLANE);
 
-	glm::mat4 projection = glm::perspective(45.0f, (float)DEFAULT_WIDTH / DEFAULT_HEIGHT, 0.1f, FAR_PLANE);
+	// noise tables, buffers and textures are startup, not frame 0
+	memoryAccounting().resetFrame();
 
-	shader.setMat4("model", model);
-	shader.setMat4("view", view);
-	shader.setMat4("projection", projection);
+	if (benchmark)
+	{
+		int result = stress ? runStressBenchmark() : runBenchmark();
+		terminateContext();
+		return result;
+	}
 
 	lastFrame = glfwGetTime();
 
@@ -82,25 +388,55 @@ int main()
 
 		processInputs();
 
-		glClearColor(skyR, skyG, skyB, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		view = mainCamera.getViewMatrix();
-		shader.setMat4("view", view);
+		if (flightRecorder.isOpen())
+			recordFlight();
 
-		glm::vec3 cameraPosition = mainCamera.getWorldPosition();
-		shader.setVec3("lightPosition", cameraPosition);
-
-		render();
+		drawFrame();
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
-	glfwTerminate();
+	terminateContext();
 	return 0;
 }
 
+void terminateContext()
+{
+	flightRecorder.close();
+
+	if (profileOnExit && profiler.frames() > 0)
+		profiler.dump(profileName);
+
+	if (TRACE_ENABLED && !traceFile.empty())
+		Trace::write(traceFile);
+
+	if (headless)
+		headlessContext.terminate();
+	else
+		glfwTerminate();
+}
+
+void drawFrame()
+{
+	profiler.beginFrame();
+
+	glClearColor(skyR, skyG, skyB, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	frameUniforms.data.view = mainCamera.getViewMatrix();
+	frameUniforms.data.lightPosition = glm::vec4(mainCamera.getWorldPosition(), 1.0f);
+	frameUniforms.upload();
+
+	activeShader = &shaders.use(frameUniforms.data.debugFlags);
+
+	profiler.beginGpu();
+	render();
+	profiler.endGpu();
+
+	profiler.endFrame();
+}
+
 int initWindow()
 {
 	// basic boilerplate code
@@ -200,9 +536,12 @@ void processInputs()
 
 	// TODO: callback later
 
+	frameUniforms.data.debugFlags = 0;
+
 	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
 	{
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		frameUniforms.data.debugFlags |= SHADER_WIREFRAME;
 	}
 	else
 	{
@@ -211,12 +550,35 @@ void processInputs()
 
 	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
 	{
-		shader.setBool("showNormals", true);
+		frameUniforms.data.debugFlags |= SHADER_DEBUG_NORMALS;
+	}
+	if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
+	{
+		frameUniforms.data.debugFlags |= SHADER_UNLIT;
+	}
+	if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
+	{
+		if (!profileKeyDown)
+			profiler.dump(profileName);
+		profileKeyDown = true;
 	}
 	else
 	{
-		shader.setBool("showNormals", false);
+		profileKeyDown = false;
+	}
+
+	if (tuneNoise)
+	{
+		int key = 0;
+		for (int candidate = GLFW_KEY_1; candidate <= GLFW_KEY_6; candidate++)
+			if (glfwGetKey(window, candidate) == GLFW_PRESS)
+				key = candidate;
+
+		if (key != 0 && !tuneKeyDown)
+			tuneFractal(key);
+		tuneKeyDown = key != 0;
 	}
+
 	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
 	{
 		mainCamera.setSpeed(CAMERA_SPEED_FAST);
@@ -227,14 +589,97 @@ void processInputs()
 	}
 }
 
+// one step of --tune-noise per key press
+void tuneFractal(int key)
+{
+	const FastNoiseLite &current = noise.get();
+	NoiseConfigBuilder builder = noise.edit();
+
+	switch (key)
+	{
+	case GLFW_KEY_1:
+		builder.fractalOctaves(std::max(1, current.GetFractalOctaves() - 1));
+		break;
+	case GLFW_KEY_2:
+		builder.fractalOctaves(current.GetFractalOctaves() + 1);
+		break;
+	case GLFW_KEY_3:
+		builder.fractalGain(std::max(0.0f, current.GetFractalGain() - TUNE_GAIN_STEP));
+		break;
+	case GLFW_KEY_4:
+		builder.fractalGain(current.GetFractalGain() + TUNE_GAIN_STEP);
+		break;
+	case GLFW_KEY_5:
+		builder.fractalWeightedStrength(std::max(0.0f, current.GetFractalWeightedStrength() - TUNE_WEIGHTED_STEP));
+		break;
+	case GLFW_KEY_6:
+		builder.fractalWeightedStrength(std::min(1.0f, current.GetFractalWeightedStrength() + TUNE_WEIGHTED_STEP));
+		break;
+	}
+
+	noise = builder.build();
+
+	std::cout << "noise: " << noise.get().GetFractalOctaves() << " octaves, gain " << noise.get().GetFractalGain()
+			  << ", weighted strength " << noise.get().GetFractalWeightedStrength() << std::endl;
+}
+
+float terrainHeight(float worldX, float worldZ)
+{
+	if (!noiseGraph.empty())
+		return NOISE_SCALE * noiseGraph.getNoise(worldX, worldZ);
+	if (warpAmp > 0.0f)
+		warp.get().DomainWarp(worldX, worldZ);
+	return NOISE_SCALE * noise.getNoise(worldX, worldZ);
+}
+
+glm::vec3 terrainNormal(float worldX, float worldZ)
+{
+	return terrainNormal(terrainHeight(worldX - DIFFUSE_EPSILON, worldZ), terrainHeight(worldX + DIFFUSE_EPSILON, worldZ),
+						 terrainHeight(worldX, worldZ - DIFFUSE_EPSILON), terrainHeight(worldX, worldZ + DIFFUSE_EPSILON));
+}
+
+// from the heights DIFFUSE_EPSILON away along -x, +x, -z and +z
+glm::vec3 terrainNormal(float left, float right, float back, float front)
+{
+	glm::vec3 xTangent = glm::vec3(-DIFFUSE_EPSILON, left, 0) - glm::vec3(DIFFUSE_EPSILON, right, 0);
+	glm::vec3 zTangent = glm::vec3(0, back, -DIFFUSE_EPSILON) - glm::vec3(0, front, DIFFUSE_EPSILON);
+
+	return glm::cross(zTangent, xTangent);
+}
+
 void render()
 {
+	if (gpuTerrain)
+	{
+		renderGpu();
+		return;
+	}
+
+	terrainOriginX = -(int)RENDER_DISTANCE / 2 + (int)mainCamera.getWorldPosition().x;
+	terrainOriginZ = -(int)RENDER_DISTANCE / 2 + (int)mainCamera.getWorldPosition().z;
+
 	// TODO: fix heightmap changing weirdly when camera moves?
-	std::vector<float> vertices;
-	std::vector<unsigned int> indices;
-	std::vector<float> normals;
+	TrackedVector<float, MEMORY_MESH_STAGING> vertices;
+	TrackedVector<unsigned int, MEMORY_MESH_STAGING> indices;
+	TrackedVector<float, MEMORY_MESH_STAGING> normals;
+
+	// generate vertices, the heights of the whole grid in one call (noise x along i, y along j).
+	// octaves finer than the 1 unit vertex spacing can't show up in the mesh, so they're skipped.
+	// the default noise is relative to the integer grid origin, so it doesn't get coarser on long flights
+	bool chunkNoise = noiseGraph.empty() && warpAmp <= 0.0f && !tuneNoise && layeredSpacing <= 0.0f;
+	profiler.begin(STAGE_NOISE);
+	TrackedVector<float, MEMORY_MESH_STAGING> heights(RENDER_DISTANCE * RENDER_DISTANCE);
+	if (!noiseGraph.empty())
+		noiseGraph.getNoiseGrid(&noiseDispatch, terrainOriginX, terrainOriginZ, 1.0f, RENDER_DISTANCE, RENDER_DISTANCE, &heights[0]);
+	else if (warpAmp > 0.0f)
+		noiseDispatch.getNoiseWarpedGrid(noise.get(), warp.get(), terrainOriginX, terrainOriginZ, 1.0f, RENDER_DISTANCE, RENDER_DISTANCE, &heights[0]);
+	else if (tuneNoise)
+		noiseLayers.getNoiseGrid(noise.get(), &noiseDispatch, terrainOriginX, terrainOriginZ, 1.0f, RENDER_DISTANCE, RENDER_DISTANCE, &heights[0]);
+	else if (layeredSpacing > 0.0f)
+		layeredNoise.getNoiseGrid(terrainOriginX, terrainOriginZ, 1.0f, RENDER_DISTANCE, RENDER_DISTANCE, &heights[0]);
+	else
+		noiseDispatch.getNoiseGridChunk(noise.get(), terrainOriginX, terrainOriginZ, 0.0f, 0.0f, 1.0f, RENDER_DISTANCE, RENDER_DISTANCE, 1.0f, &heights[0]);
 
-	// generate vertices
 	for (int i = 0; i < RENDER_DISTANCE; i++)
 	{
 		for (int j = 0; j < RENDER_DISTANCE; j++)
@@ -246,14 +691,17 @@ void render()
 			// float worldZ = (float)j;
 			vertices.push_back(worldX);
 
-			float height = NOISE_SCALE * noise.GetNoise(worldX, worldZ);
+			// terrainHeight(worldX, worldZ), relative to the grid origin on the default path
+			float height = NOISE_SCALE * heights[j * (int)RENDER_DISTANCE + i];
 
 			vertices.push_back(height);
 			vertices.push_back(worldZ);
 		}
 	}
+	profiler.end(STAGE_NOISE);
 
 	// generate indices
+	profiler.begin(STAGE_INDICES);
 	for (int i = 0; i < RENDER_DISTANCE - 1; i++)
 	{
 		for (int j = 0; j < RENDER_DISTANCE - 1; j++)
@@ -267,8 +715,19 @@ void render()
 			indices.push_back(RENDER_DISTANCE * (i + 1) + j + 1);
 		}
 	}
+	profiler.end(STAGE_INDICES);
+
+	// generate normals. far out DIFFUSE_EPSILON is below the float spacing of world
+	// coordinates, so the default path samples the neighbours relative to the grid origin too,
+	// with every octave like terrainHeight
+	profiler.begin(STAGE_NORMALS);
+	const int gridSize = RENDER_DISTANCE * RENDER_DISTANCE;
+	const float neighbourOffsets[4][2] = {{-DIFFUSE_EPSILON, 0.0f}, {DIFFUSE_EPSILON, 0.0f}, {0.0f, -DIFFUSE_EPSILON}, {0.0f, DIFFUSE_EPSILON}};
+	TrackedVector<float, MEMORY_MESH_STAGING> neighbours(chunkNoise ? 4 * gridSize : 0);
+	for (int k = 0; chunkNoise && k < 4; k++)
+		noiseDispatch.getNoiseGridChunk(noise.get(), terrainOriginX, terrainOriginZ, neighbourOffsets[k][0], neighbourOffsets[k][1], 1.0f, RENDER_DISTANCE,
+										RENDER_DISTANCE, 0.0f, &neighbours[k * gridSize]);
 
-	// generate normals
 	for (int i = 0; i < RENDER_DISTANCE; i++)
 	{
 		for (int j = 0; j < RENDER_DISTANCE; j++)
@@ -280,16 +739,19 @@ void render()
 			// float worldX = (float)i;
 			// float worldZ = (float)j;
 
-			glm::vec3 xTangent = glm::vec3(-DIFFUSE_EPSILON, NOISE_SCALE * noise.GetNoise(worldX - DIFFUSE_EPSILON, worldZ), 0) - glm::vec3(DIFFUSE_EPSILON, NOISE_SCALE * noise.GetNoise(worldX + DIFFUSE_EPSILON, worldZ), 0);
-			glm::vec3 zTangent = glm::vec3(0, NOISE_SCALE * noise.GetNoise(worldX, worldZ - DIFFUSE_EPSILON), -DIFFUSE_EPSILON) - glm::vec3(0, NOISE_SCALE * noise.GetNoise(worldX, worldZ + DIFFUSE_EPSILON), DIFFUSE_EPSILON);
-
-			glm::vec3 norm = glm::cross(zTangent, xTangent);
+			int index = j * (int)RENDER_DISTANCE + i;
+			glm::vec3 norm = chunkNoise ? terrainNormal(NOISE_SCALE * neighbours[index], NOISE_SCALE * neighbours[gridSize + index],
+														NOISE_SCALE * neighbours[2 * gridSize + index], NOISE_SCALE * neighbours[3 * gridSize + index])
+										: terrainNormal(worldX, worldZ);
 
 			normals.push_back(norm.x);
 			normals.push_back(norm.y);
 			normals.push_back(norm.z);
 		}
 	}
+	profiler.end(STAGE_NORMALS);
+
+	profiler.begin(STAGE_UPLOAD);
 
 	unsigned int VAO;
 	glGenVertexArrays(1, &VAO);
@@ -318,9 +780,337 @@ void render()
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
+	size_t vertexBytes = (vertices.size() + normals.size()) * sizeof(float);
+	size_t indexBytes = indices.size() * sizeof(unsigned int);
+	memoryAccounting().allocateGpu(GPU_MEMORY_TERRAIN_VERTICES, vertexBytes);
+	memoryAccounting().allocateGpu(GPU_MEMORY_TERRAIN_INDICES, indexBytes);
+
+	profiler.end(STAGE_UPLOAD);
+
+	ProfileScope draw(profiler, STAGE_DRAW);
+
 	glDrawElements(GL_TRIANGLES, (RENDER_DISTANCE - 1) * (RENDER_DISTANCE - 1) * 6, GL_UNSIGNED_INT, 0);
 
 	glDeleteBuffers(2, VBO);
 	glDeleteBuffers(1, &EBO);
 	glDeleteVertexArrays(1, &VAO);
+
+	memoryAccounting().freeGpu(GPU_MEMORY_TERRAIN_VERTICES, vertexBytes);
+	memoryAccounting().freeGpu(GPU_MEMORY_TERRAIN_INDICES, indexBytes);
+}
+
+void renderGpu()
+{
+	int originX = -(int)RENDER_DISTANCE / 2 + (int)mainCamera.getWorldPosition().x;
+	int originZ = -(int)RENDER_DISTANCE / 2 + (int)mainCamera.getWorldPosition().z;
+
+	terrainOriginX = originX;
+	terrainOriginZ = originZ;
+
+	// the compute dispatch replaces the noise, normal and upload stages
+	profiler.begin(STAGE_NOISE);
+	heightfield.generate(originX, originZ);
+	profiler.end(STAGE_NOISE);
+
+	ProfileScope draw(profiler, STAGE_DRAW);
+
+	activeShader->use();
+	heightfield.draw();
+}
+
+// compares heightfield.comp against the CPU noise, returns non-zero on mismatch
+int verifyGpuHeightfield()
+{
+	if (!heightfield.isReady())
+	{
+		std::cout << "GPU heightfield: not supported on this context" << std::endl;
+		return -1;
+	}
+
+	const int origins[][2] = {{-50, -50}, {1234, -5678}, {-100000, 250000}};
+
+	float maxHeightError = 0.0f;
+	float maxNormalError = 0.0f;
+
+	std::vector<float> positions;
+	std::vector<float> normals;
+
+	for (const auto &origin : origins)
+	{
+		heightfield.generate(origin[0], origin[1]);
+		heightfield.readback(positions, normals);
+
+		for (int i = 0; i < RENDER_DISTANCE; i++)
+		{
+			for (int j = 0; j < RENDER_DISTANCE; j++)
+			{
+				int index = (i * (int)RENDER_DISTANCE + j) * 4;
+
+				float worldX = origin[0] + i;
+				float worldZ = origin[1] + j;
+
+				float heightError = std::fabs(positions[index + 1] - terrainHeight(worldX, worldZ));
+
+				glm::vec3 gpuNormal = glm::normalize(glm::vec3(normals[index], normals[index + 1], normals[index + 2]));
+				glm::vec3 normalError = gpuNormal - glm::normalize(terrainNormal(worldX, worldZ));
+
+				maxHeightError = std::fmax(maxHeightError, heightError);
+				maxNormalError = std::fmax(maxNormalError, glm::length(normalError));
+			}
+		}
+	}
+
+	bool passed = maxHeightError <= HEIGHTFIELD_TOLERANCE && maxNormalError <= HEIGHTFIELD_NORMAL_TOLERANCE;
+
+	std::cout << "GPU heightfield: max height error " << maxHeightError << " (tolerance " << HEIGHTFIELD_TOLERANCE << ")"
+			  << ", max normal error " << maxNormalError << " (tolerance " << HEIGHTFIELD_NORMAL_TOLERANCE << ")"
+			  << (passed ? " PASSED" : " FAILED") << std::endl;
+
+	return passed ? 0 : 1;
+}
+
+// renders benchmarkFrames frames spread evenly over the camera path, so every
+// run draws exactly the same views regardless of how fast the machine is
+int runBenchmark()
+{
+	CameraPath path = CameraPath::defaultPath();
+	if (!cameraPathFile.empty() && !path.load(cameraPathFile))
+		return -1;
+
+	if (!replayFile.empty())
+	{
+		if (!loadFlight(replayFile, path))
+			return -1;
+
+		// up to the end of the flight, the last frame is sampled at or past it
+		if (!benchmarkFramesSet)
+			benchmarkFrames = (int)std::ceil(path.duration() / REPLAY_TIMESTEP) + 1;
+	}
+
+	if (!headless)
+		glfwSwapInterval(0);
+
+	if (!captureDir.empty())
+	{
+		std::error_code error;
+		std::filesystem::create_directories(captureDir, error);
+	}
+
+	// recordings replay at the fixed step, scripted paths and --frames spread the frames
+	// over the whole path
+	bool fixedStep = !replayFile.empty() && !benchmarkFramesSet;
+	float timestep = fixedStep ? REPLAY_TIMESTEP : path.duration() / benchmarkFrames;
+	FrameStats stats;
+
+	std::vector<PathTiming> timings;
+	float distance = 0.0f;
+	glm::vec3 lastPosition = path.sample(0.0f).position;
+
+	for (int frame = 0; frame < benchmarkFrames; frame++)
+	{
+		CameraKeyframe keyframe = path.sample(frame * timestep);
+
+		distance += glm::length(keyframe.position - lastPosition);
+		lastPosition = keyframe.position;
+
+		double milliseconds = drawBenchmarkFrame(keyframe, timestep);
+		stats.add(milliseconds);
+		timings.push_back({frame, keyframe.time, distance, keyframe.position, milliseconds});
+
+		if (!captureDir.empty() && captureInterval > 0 && frame % captureInterval == 0)
+			captureFrame(frame);
+
+		if (!headless)
+		{
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+			if (glfwWindowShouldClose(window))
+				break;
+		}
+	}
+
+	stats.print("benchmark");
+	profiler.print();
+
+	if (!resultsFile.empty())
+	{
+		BenchmarkResults results(replayFile.empty() ? "camera_path" : "flight_replay");
+		stats.addMetrics(results, "");
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+			results.add(std::string("stage_") + PROFILE_STAGE_NAMES[stage] + "_ms_mean", profiler.stageMean((ProfileStage)stage));
+		results.add("gpu_ms_mean", profiler.gpuMean());
+		results.add("gpu_dropped_frames", profiler.gpuDroppedFrames());
+		results.add("cpu_memory_peak_bytes", memoryAccounting().cpuTotal(true));
+		results.add("gpu_memory_peak_bytes", memoryAccounting().gpuTotal(true));
+		results.add("allocations_peak_frame", memoryAccounting().allocationsPeakFrame());
+
+		if (profiler.hasCounters())
+		{
+			for (int stage = 0; stage < STAGE_COUNT; stage++)
+				for (int counter = 0; counter < COUNTER_COUNT; counter++)
+					results.add(std::string("stage_") + PROFILE_STAGE_NAMES[stage] + "_" + PERF_COUNTER_NAMES[counter] + "_per_frame", profiler.counterMean((ProfileStage)stage, (PerfCounter)counter));
+		}
+		if (!results.write(resultsFile))
+			return -1;
+	}
+
+	if (!timingsFile.empty() && !writeTimings(timingsFile, timings))
+		return -1;
+
+	return 0;
+}
+
+// flies every STRESS_PATTERN_NAMES pattern at every --speeds speed. the score is the
+// mean of min(1, budget / frame time) over all frames, 100 means nothing ever hitched
+int runStressBenchmark()
+{
+	if (!headless)
+		glfwSwapInterval(0);
+
+	BenchmarkResults results("streaming_stress");
+
+	int frames = 0;
+	int hitches = 0;
+	int notReady = 0;
+	double worst = 0.0;
+	double score = 0.0;
+
+	for (int pattern = 0; pattern < STRESS_PATTERN_COUNT; pattern++)
+	{
+		for (float speed : stressSpeeds)
+		{
+			CameraPath path = stressPath((StressPattern)pattern, speed, stressSeconds, REPLAY_TIMESTEP);
+			FrameStats stats;
+			int scenarioNotReady = 0;
+
+			for (float time = 0.0f; time <= path.duration(); time += REPLAY_TIMESTEP)
+			{
+				double milliseconds = drawBenchmarkFrame(path.sample(time), REPLAY_TIMESTEP);
+				stats.add(milliseconds);
+				score += std::min(1.0, hitchBudget / milliseconds);
+
+				if (!terrainReady())
+					scenarioNotReady++;
+
+				if (!headless)
+				{
+					glfwSwapBuffers(window);
+					glfwPollEvents();
+				}
+			}
+
+			std::string name = std::string(STRESS_PATTERN_NAMES[pattern]) + "_" + std::to_string((int)speed);
+			std::cout << "stress " << name << ": " << stats.hitches(hitchBudget) << " hitches over " << hitchBudget << " ms"
+					  << ", worst " << stats.max() << " ms, " << scenarioNotReady << " not ready" << std::endl;
+
+			results.add(name + "_hitches", stats.hitches(hitchBudget));
+			results.add(name + "_worst_ms", stats.max());
+			results.add(name + "_not_ready", scenarioNotReady);
+
+			frames += stats.count();
+			hitches += stats.hitches(hitchBudget);
+			notReady += scenarioNotReady;
+			worst = std::max(worst, stats.max());
+		}
+	}
+
+	score = frames ? 100.0 * score / frames : 0.0;
+	std::cout << "stress: " << frames << " frames, " << hitches << " hitches, worst " << worst << " ms, "
+			  << notReady << " not ready, score " << score << std::endl;
+
+	results.add("frames", frames);
+	results.add("hitches", hitches);
+	results.add("worst_ms", worst);
+	results.add("not_ready", notReady);
+	results.setting("budget_ms", hitchBudget);
+	results.add("stress_score", score);
+
+	if (!resultsFile.empty() && !results.write(resultsFile))
+		return -1;
+
+	return 0;
+}
+
+// places the camera and draws one benchmark frame, returns its time in milliseconds
+double drawBenchmarkFrame(const CameraKeyframe &keyframe, float timestep)
+{
+	mainCamera.setWorldPosition(keyframe.position);
+	mainCamera.setAngles(keyframe.yaw, keyframe.pitch);
+	deltaTime = timestep;
+
+	// recordings can switch debug views mid flight
+	frameUniforms.data.debugFlags = keyframe.debugFlags;
+	glPolygonMode(GL_FRONT_AND_BACK, keyframe.debugFlags & SHADER_WIREFRAME ? GL_LINE : GL_FILL);
+
+	auto start = std::chrono::steady_clock::now();
+
+	drawFrame();
+	// wait for the GPU so the time covers the whole frame, not just command submission
+	{
+		TRACE_SCOPE("finish");
+		glFinish();
+	}
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// whether the last frame drew terrain around the camera's current cell. terrain
+// is generated synchronously in render() for now, so this only fails once
+// generation lags behind the camera
+bool terrainReady()
+{
+	int originX = -(int)RENDER_DISTANCE / 2 + (int)mainCamera.getWorldPosition().x;
+	int originZ = -(int)RENDER_DISTANCE / 2 + (int)mainCamera.getWorldPosition().z;
+
+	return originX == terrainOriginX && originZ == terrainOriginZ;
+}
+
+// appends the camera state after this frame's input to the --record file
+void recordFlight()
+{
+	const int keyBindings[][2] = {
+		{GLFW_KEY_W, FLIGHT_KEY_FORWARD},
+		{GLFW_KEY_S, FLIGHT_KEY_BACKWARD},
+		{GLFW_KEY_A, FLIGHT_KEY_LEFT},
+		{GLFW_KEY_D, FLIGHT_KEY_RIGHT},
+		{GLFW_KEY_SPACE, FLIGHT_KEY_UP},
+		{GLFW_KEY_LEFT_CONTROL, FLIGHT_KEY_DOWN},
+		{GLFW_KEY_LEFT_SHIFT, FLIGHT_KEY_FAST},
+	};
+
+	FlightRecord record;
+	record.time = recordTime;
+	record.position[0] = mainCamera.getWorldPosition().x;
+	record.position[1] = mainCamera.getWorldPosition().y;
+	record.position[2] = mainCamera.getWorldPosition().z;
+	record.yaw = mainCamera.getYaw();
+	record.pitch = mainCamera.getPitch();
+	record.debugFlags = frameUniforms.data.debugFlags;
+
+	record.keys = 0;
+	for (const auto &binding : keyBindings)
+	{
+		if (glfwGetKey(window, binding[0]) == GLFW_PRESS)
+			record.keys |= binding[1];
+	}
+
+	flightRecorder.record(record);
+	recordTime += deltaTime;
+}
+
+void captureFrame(int frame)
+{
+	std::vector<unsigned char> pixels(DEFAULT_WIDTH * DEFAULT_HEIGHT * 4);
+	glReadPixels(0, 0, DEFAULT_WIDTH, DEFAULT_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+
+	// GL rows start at the bottom, PNG rows at the top
+	std::vector<unsigned char> flipped(pixels.size());
+	for (int y = 0; y < DEFAULT_HEIGHT; y++)
+		memcpy(&flipped[y * DEFAULT_WIDTH * 4], &pixels[(DEFAULT_HEIGHT - 1 - y) * DEFAULT_WIDTH * 4], DEFAULT_WIDTH * 4);
+
+	char name[32];
+	snprintf(name, sizeof(name), "/frame_%05d.png", frame);
+
+	if (!Png::write(captureDir + name, DEFAULT_WIDTH, DEFAULT_HEIGHT, &flipped[0]))
+		std::cout << "Failed to write " << captureDir + name << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef MATERIALS_H
+#define MATERIALS_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "memstats.h"
+
+// texels across the ramp, at the default range one texel covers 1/8 unit
+const int MATERIAL_RAMP_RESOLUTION = 1024;
+
+// a band of terrain colored from minHeight up to the next band
+struct Material
+{
+	float minHeight;
+	glm::vec3 color;
+};
+
+// sorted by minHeight, the first band also covers everything below it
+const std::vector<Material> DEFAULT_MATERIALS = {
+	{-1e10f, glm::vec3(14.0f / 255.0f, 131.0f / 255.0f, 198.0f / 255.0f)}, // water
+	{0.0f, glm::vec3(0.76f, 0.70f, 0.50f)}, // sand
+	{20.0f, glm::vec3(91.0f / 255.0f, 91.0f / 255.0f, 91.0f / 255.0f)}, // rock
+	{45.0f, glm::vec3(1.0f, 1.0f, 1.0f)}, // snow
+};
+
+// height -> color lookup texture baked from a material table, so the fragment
+// shader does one texture fetch instead of a branch per band
+class MaterialRamp
+{
+private:
+	unsigned int texture = 0;
+
+	float minHeight = 0.0f;
+	float maxHeight = 1.0f;
+
+public:
+	void init(float minHeight, float maxHeight)
+	{
+		this->minHeight = minHeight;
+		this->maxHeight = maxHeight;
+
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_1D, texture);
+		glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, MATERIAL_RAMP_RESOLUTION, 0, GL_RGB, GL_FLOAT, NULL);
+		memoryAccounting().allocateGpu(GPU_MEMORY_TEXTURES, MATERIAL_RAMP_RESOLUTION * 3);
+
+		// nearest keeps the bands hard edged like the old if chain
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	}
+
+	// rebakes the ramp, can be called at any time
+	void update(const std::vector<Material> &materials)
+	{
+		std::vector<float> texels(MATERIAL_RAMP_RESOLUTION * 3);
+
+		for (int i = 0; i < MATERIAL_RAMP_RESOLUTION; i++)
+		{
+			float height = minHeight + (i + 0.5f) / MATERIAL_RAMP_RESOLUTION * (maxHeight - minHeight);
+
+			glm::vec3 color = materials.empty() ? glm::vec3(1.0f) : materials[0].color;
+			for (const Material &material : materials)
+			{
+				if (height > material.minHeight)
+					color = material.color;
+			}
+
+			texels[i * 3] = color.x;
+			texels[i * 3 + 1] = color.y;
+			texels[i * 3 + 2] = color.z;
+		}
+
+		glBindTexture(GL_TEXTURE_1D, texture);
+		glTexSubImage1D(GL_TEXTURE_1D, 0, 0, MATERIAL_RAMP_RESOLUTION, GL_RGB, GL_FLOAT, &texels[0]);
+	}
+
+	void bind(unsigned int unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_1D, texture);
+	}
+
+	glm::vec2 getRange()
+	{
+		return glm::vec2(minHeight, maxHeight);
+	}
+};
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+// memory accounting by category: CPU allocations made through TrackedAllocator
+// and the GL buffer/texture bytes the terrain code reports as it creates them.
+// shown by the profiler dump, see Profiler::writeJson
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+enum MemoryCategory
+{
+	MEMORY_MESH_STAGING, // per frame vertex/index vectors built on the CPU
+	MEMORY_CHUNK_CACHE, // generated terrain kept between frames
+	MEMORY_NOISE_TABLES, // FastNoiseLite lookup tables, static
+	MEMORY_CATEGORY_COUNT
+};
+
+const char *const MEMORY_CATEGORY_NAMES[MEMORY_CATEGORY_COUNT] = {"mesh_staging", "chunk_cache", "noise_tables"};
+
+enum GpuMemoryCategory
+{
+	GPU_MEMORY_TERRAIN_VERTICES,
+	GPU_MEMORY_TERRAIN_INDICES,
+	GPU_MEMORY_NOISE_TABLES,
+	GPU_MEMORY_UNIFORMS,
+	GPU_MEMORY_TEXTURES,
+	GPU_MEMORY_FRAMEBUFFER,
+	GPU_MEMORY_CATEGORY_COUNT
+};
+
+const char *const GPU_MEMORY_CATEGORY_NAMES[GPU_MEMORY_CATEGORY_COUNT] = {"terrain_vertices", "terrain_indices", "noise_tables", "uniforms", "textures", "framebuffer"};
+
+// bytes in use, the most that was ever in use and the number of allocations.
+// atomic so worker threads can allocate from the tracked categories
+struct MemoryCounter
+{
+	std::atomic<long long> current{0};
+	std::atomic<long long> peak{0};
+	std::atomic<long long> allocations{0};
+
+	void add(long long bytes)
+	{
+		long long now = current += bytes;
+		long long highest = peak.load(std::memory_order_relaxed);
+		while (now > highest && !peak.compare_exchange_weak(highest, now))
+			;
+		allocations++;
+	}
+
+	void remove(long long bytes)
+	{
+		current -= bytes;
+	}
+};
+
+class MemoryAccounting
+{
+private:
+	MemoryCounter cpu[MEMORY_CATEGORY_COUNT];
+	MemoryCounter gpu[GPU_MEMORY_CATEGORY_COUNT];
+
+	std::atomic<long long> frameAllocations{0};
+	long long lastFrameAllocations = 0;
+	long long peakFrameAllocations = 0;
+
+	static long long total(const MemoryCounter *counters, int count, bool peak)
+	{
+		long long bytes = 0;
+		for (int i = 0; i < count; i++)
+			bytes += peak ? counters[i].peak.load() : counters[i].current.load();
+		return bytes;
+	}
+
+public:
+	void allocate(MemoryCategory category, size_t bytes)
+	{
+		cpu[category].add(bytes);
+		frameAllocations++;
+	}
+
+	void free(MemoryCategory category, size_t bytes)
+	{
+		cpu[category].remove(bytes);
+	}
+
+	void allocateGpu(GpuMemoryCategory category, size_t bytes)
+	{
+		gpu[category].add(bytes);
+		frameAllocations++;
+	}
+
+	void freeGpu(GpuMemoryCategory category, size_t bytes)
+	{
+		gpu[category].remove(bytes);
+	}
+
+	// drops what was counted so far without closing a frame, so startup isn't
+	// taken for the first frame's allocations
+	void resetFrame()
+	{
+		frameAllocations = 0;
+	}
+
+	// closes the per frame allocation count
+	void endFrame()
+	{
+		lastFrameAllocations = frameAllocations.exchange(0);
+		if (lastFrameAllocations > peakFrameAllocations)
+			peakFrameAllocations = lastFrameAllocations;
+	}
+
+	const MemoryCounter &cpuCounter(MemoryCategory category) const
+	{
+		return cpu[category];
+	}
+
+	const MemoryCounter &gpuCounter(GpuMemoryCategory category) const
+	{
+		return gpu[category];
+	}
+
+	// peak totals are the sum of each category's peak, an upper bound of the real peak
+	long long cpuTotal(bool peak = false) const
+	{
+		return total(cpu, MEMORY_CATEGORY_COUNT, peak);
+	}
+
+	long long gpuTotal(bool peak = false) const
+	{
+		return total(gpu, GPU_MEMORY_CATEGORY_COUNT, peak);
+	}
+
+	long long allocationsLastFrame() const
+	{
+		return lastFrameAllocations;
+	}
+
+	long long allocationsPeakFrame() const
+	{
+		return peakFrameAllocations;
+	}
+
+	void print() const
+	{
+		std::cout << "memory: cpu " << cpuTotal() << " bytes (peak " << cpuTotal(true) << "), gpu " << gpuTotal()
+				  << " bytes (peak " << gpuTotal(true) << "), allocations per frame " << lastFrameAllocations
+				  << " (peak " << peakFrameAllocations << ")" << std::endl;
+	}
+};
+
+inline MemoryAccounting &memoryAccounting()
+{
+	static MemoryAccounting accounting;
+	return accounting;
+}
+
+// std::allocator that reports to memoryAccounting() under a fixed category
+template <typename T, MemoryCategory category>
+struct TrackedAllocator
+{
+	typedef T value_type;
+
+	template <typename U>
+	struct rebind
+	{
+		typedef TrackedAllocator<U, category> other;
+	};
+
+	TrackedAllocator() = default;
+
+	template <typename U>
+	TrackedAllocator(const TrackedAllocator<U, category> &) {}
+
+	T *allocate(size_t count)
+	{
+		memoryAccounting().allocate(category, count * sizeof(T));
+		return std::allocator<T>().allocate(count);
+	}
+
+	void deallocate(T *pointer, size_t count)
+	{
+		memoryAccounting().free(category, count * sizeof(T));
+		std::allocator<T>().deallocate(pointer, count);
+	}
+
+	template <typename U>
+	bool operator==(const TrackedAllocator<U, category> &) const
+	{
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const TrackedAllocator<U, category> &) const
+	{
+		return false;
+	}
+};
+
+template <typename T, MemoryCategory category>
+using TrackedVector = std::vector<T, TrackedAllocator<T, category>>;
+
+#endif
@@ -0,0 +1,421 @@
+// microbenchmarks of everything render() does besides noise: index generation,
+// normals, vertex packing and GL upload strategies, over grid sizes 64^2...4096^2.
+// the upload benchmarks need the headless EGL context, the CPU stages run anywhere:
+//   g++ -std=c++17 -O2 -DGLTERRAIN_EGL meshbench.cpp glad.c -o meshbench -lEGL
+//   ./meshbench [--max-size 1024] [--filter upload] [--results mesh.json]
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "fastnoise.h"
+#include "headless.h"
+#include "benchmark.h"
+
+const int MESHBENCH_SIZES[] = {64, 128, 256, 512, 1024, 2048, 4096};
+
+// every case repeats for at least this long, the median run is reported
+const double MESHBENCH_MIN_MS = 100.0;
+
+// normals straight from the noise cost 4 samples per vertex, beyond this it takes minutes
+const int MESHBENCH_NOISE_NORMALS_MAX_SIZE = 1024;
+
+// regions of the persistently mapped buffer, so the CPU writes one while the GPU reads another
+const int MESHBENCH_PERSISTENT_REGIONS = 3;
+
+// same terrain as main.cpp
+const float MESHBENCH_NOISE_SCALE = 64.0f;
+const float MESHBENCH_EPSILON = 0.01f;
+
+FastNoiseLite noise;
+
+BenchmarkResults results("mesh");
+std::string filter;
+
+// the input every stage starts from, heights of a (size + 2)^2 grid so the
+// heightfield normals have a one vertex border
+struct MeshInput
+{
+	int size;
+	std::vector<float> heights;
+
+	float height(int i, int j) const
+	{
+		return heights[(i + 1) * (size + 2) + (j + 1)];
+	}
+};
+
+// the three packings compared by the upload benchmarks
+struct MeshData
+{
+	std::vector<float> positions; // separate: xyz per vertex
+	std::vector<float> normals; // separate: xyz per vertex
+	std::vector<float> interleaved; // position xyz, normal xyz
+	std::vector<unsigned int> packed; // position xyz as floats, normal as GL_INT_2_10_10_10_REV
+};
+
+// median milliseconds of f over runs lasting at least MESHBENCH_MIN_MS together
+template <typename F>
+double measure(F &&f)
+{
+	std::vector<double> times;
+	double total = 0.0;
+	while (total < MESHBENCH_MIN_MS)
+	{
+		auto start = std::chrono::steady_clock::now();
+		f();
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		times.push_back(elapsed);
+		total += elapsed;
+	}
+
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+// records one case as milliseconds and nanoseconds per vertex, the latter compares across sizes
+template <typename F>
+void run(const std::string &stage, const std::string &strategy, int size, F &&f)
+{
+	std::string name = stage + "_" + strategy + "_" + std::to_string(size);
+	if (name.find(filter) == std::string::npos)
+		return;
+
+	double milliseconds = measure(f);
+	double nanosecondsPerVertex = milliseconds * 1e6 / ((double)size * size);
+
+	std::cout << name << ": " << milliseconds << " ms, " << nanosecondsPerVertex << " ns/vertex" << std::endl;
+
+	results.add(name + "_ms", milliseconds);
+	results.add(name + "_ns_per_vertex", nanosecondsPerVertex);
+}
+
+MeshInput generateInput(int size)
+{
+	MeshInput input;
+	input.size = size;
+	input.heights.resize((size_t)(size + 2) * (size + 2));
+
+	for (int i = -1; i <= size; i++)
+		for (int j = -1; j <= size; j++)
+			input.heights[(i + 1) * (size + 2) + (j + 1)] = MESHBENCH_NOISE_SCALE * noise.GetNoise((float)i, (float)j);
+
+	return input;
+}
+
+void benchmarkIndices(int size)
+{
+	std::vector<unsigned int> indices;
+
+	// what render() does
+	run("indices", "pushback", size, [&]() {
+		std::vector<unsigned int> fresh;
+		for (int i = 0; i < size - 1; i++)
+		{
+			for (int j = 0; j < size - 1; j++)
+			{
+				fresh.push_back(size * i + j);
+				fresh.push_back(size * i + j + 1);
+				fresh.push_back(size * (i + 1) + j);
+
+				fresh.push_back(size * (i + 1) + j);
+				fresh.push_back(size * i + j + 1);
+				fresh.push_back(size * (i + 1) + j + 1);
+			}
+		}
+		indices.swap(fresh);
+	});
+
+	run("indices", "reserved", size, [&]() {
+		std::vector<unsigned int> fresh;
+		fresh.reserve((size_t)(size - 1) * (size - 1) * 6);
+		for (int i = 0; i < size - 1; i++)
+		{
+			for (int j = 0; j < size - 1; j++)
+			{
+				fresh.push_back(size * i + j);
+				fresh.push_back(size * i + j + 1);
+				fresh.push_back(size * (i + 1) + j);
+
+				fresh.push_back(size * (i + 1) + j);
+				fresh.push_back(size * i + j + 1);
+				fresh.push_back(size * (i + 1) + j + 1);
+			}
+		}
+		indices.swap(fresh);
+	});
+
+	// reuses the previous allocation, like a persistent index buffer would
+	indices.resize((size_t)(size - 1) * (size - 1) * 6);
+	run("indices", "inplace", size, [&]() {
+		unsigned int *out = &indices[0];
+		for (int i = 0; i < size - 1; i++)
+		{
+			for (int j = 0; j < size - 1; j++)
+			{
+				unsigned int corner = size * i + j;
+				out[0] = corner;
+				out[1] = corner + 1;
+				out[2] = corner + size;
+				out[3] = corner + size;
+				out[4] = corner + 1;
+				out[5] = corner + size + 1;
+				out += 6;
+			}
+		}
+	});
+}
+
+void benchmarkNormals(const MeshInput &input, MeshData &mesh)
+{
+	int size = input.size;
+	mesh.normals.resize((size_t)size * size * 3);
+
+	// what render() does: central differences of the noise itself, 4 extra samples per vertex
+	if (size <= MESHBENCH_NOISE_NORMALS_MAX_SIZE)
+	{
+		run("normals", "noise", size, [&]() {
+			float *out = &mesh.normals[0];
+			for (int i = 0; i < size; i++)
+			{
+				for (int j = 0; j < size; j++)
+				{
+					float x = (float)i;
+					float z = (float)j;
+					glm::vec3 xTangent = glm::vec3(-MESHBENCH_EPSILON, MESHBENCH_NOISE_SCALE * noise.GetNoise(x - MESHBENCH_EPSILON, z), 0) - glm::vec3(MESHBENCH_EPSILON, MESHBENCH_NOISE_SCALE * noise.GetNoise(x + MESHBENCH_EPSILON, z), 0);
+					glm::vec3 zTangent = glm::vec3(0, MESHBENCH_NOISE_SCALE * noise.GetNoise(x, z - MESHBENCH_EPSILON), -MESHBENCH_EPSILON) - glm::vec3(0, MESHBENCH_NOISE_SCALE * noise.GetNoise(x, z + MESHBENCH_EPSILON), MESHBENCH_EPSILON);
+					glm::vec3 normal = glm::cross(zTangent, xTangent);
+
+					*out++ = normal.x;
+					*out++ = normal.y;
+					*out++ = normal.z;
+				}
+			}
+		});
+	}
+
+	// central differences of the already generated heights, one vertex apart. no noise
+	// samples at all, but smoother than the epsilon normals
+	run("normals", "heightfield", size, [&]() {
+		float *out = &mesh.normals[0];
+		for (int i = 0; i < size; i++)
+		{
+			for (int j = 0; j < size; j++)
+			{
+				glm::vec3 normal = glm::normalize(glm::vec3(input.height(i - 1, j) - input.height(i + 1, j), 2.0f, input.height(i, j - 1) - input.height(i, j + 1)));
+
+				*out++ = normal.x;
+				*out++ = normal.y;
+				*out++ = normal.z;
+			}
+		}
+	});
+}
+
+// 10 bit signed normalized component of GL_INT_2_10_10_10_REV
+unsigned int packSnorm10(float value)
+{
+	float clamped = std::min(std::max(value, -1.0f), 1.0f) * 511.0f;
+	int scaled = (int)(clamped + (clamped >= 0.0f ? 0.5f : -0.5f));
+	return (unsigned int)scaled & 0x3ff;
+}
+
+void benchmarkPacking(const MeshInput &input, MeshData &mesh)
+{
+	int size = input.size;
+	size_t vertices = (size_t)size * size;
+
+	mesh.positions.resize(vertices * 3);
+	mesh.interleaved.resize(vertices * 6);
+	mesh.packed.resize(vertices * 4);
+
+	// what render() does: positions and normals in two arrays
+	run("packing", "separate", size, [&]() {
+		float *out = &mesh.positions[0];
+		for (int i = 0; i < size; i++)
+		{
+			for (int j = 0; j < size; j++)
+			{
+				*out++ = (float)i;
+				*out++ = input.height(i, j);
+				*out++ = (float)j;
+			}
+		}
+	});
+
+	run("packing", "interleaved", size, [&]() {
+		float *out = &mesh.interleaved[0];
+		const float *normal = &mesh.normals[0];
+		for (int i = 0; i < size; i++)
+		{
+			for (int j = 0; j < size; j++)
+			{
+				*out++ = (float)i;
+				*out++ = input.height(i, j);
+				*out++ = (float)j;
+				*out++ = *normal++;
+				*out++ = *normal++;
+				*out++ = *normal++;
+			}
+		}
+	});
+
+	// 16 bytes per vertex instead of 24
+	run("packing", "packed", size, [&]() {
+		unsigned int *out = &mesh.packed[0];
+		const float *normal = &mesh.normals[0];
+		for (int i = 0; i < size; i++)
+		{
+			for (int j = 0; j < size; j++)
+			{
+				float position[3] = {(float)i, input.height(i, j), (float)j};
+				memcpy(out, position, sizeof(position));
+				out[3] = packSnorm10(normal[0]) | packSnorm10(normal[1]) << 10 | packSnorm10(normal[2]) << 20;
+				out += 4;
+				normal += 3;
+			}
+		}
+	});
+}
+
+// every strategy uploads the interleaved vertices and waits for the GL to finish with them
+void benchmarkUploads(const MeshData &mesh, int size)
+{
+	const void *data = &mesh.interleaved[0];
+	GLsizeiptr bytes = mesh.interleaved.size() * sizeof(float);
+
+	// what render() does: a new buffer every frame
+	run("upload", "create", size, [&]() {
+		unsigned int VBO;
+		glGenBuffers(1, &VBO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_DYNAMIC_DRAW);
+		glFinish();
+		glDeleteBuffers(1, &VBO);
+	});
+
+	unsigned int VBO;
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_DYNAMIC_DRAW);
+
+	// respecify the same buffer, the driver may orphan the old storage
+	run("upload", "bufferdata", size, [&]() {
+		glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_DYNAMIC_DRAW);
+		glFinish();
+	});
+
+	// explicit orphaning, then fill the fresh storage
+	run("upload", "orphan", size, [&]() {
+		glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
+		glFinish();
+	});
+
+	run("upload", "subdata", size, [&]() {
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
+		glFinish();
+	});
+
+	glDeleteBuffers(1, &VBO);
+
+	if (!GLAD_GL_VERSION_4_4)
+	{
+		std::cout << "upload_persistent: needs GL 4.4, skipped" << std::endl;
+		return;
+	}
+
+	// one immutable buffer mapped for the whole run, regions are reused after their fence signals
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glBufferStorage(GL_ARRAY_BUFFER, bytes * MESHBENCH_PERSISTENT_REGIONS, NULL, flags);
+	char *mapped = (char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes * MESHBENCH_PERSISTENT_REGIONS, flags);
+
+	GLsync fences[MESHBENCH_PERSISTENT_REGIONS] = {};
+	int region = 0;
+
+	run("upload", "persistent", size, [&]() {
+		if (fences[region])
+		{
+			glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(fences[region]);
+		}
+
+		memcpy(mapped + bytes * region, data, bytes);
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFinish();
+
+		region = (region + 1) % MESHBENCH_PERSISTENT_REGIONS;
+	});
+
+	for (GLsync fence : fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+	}
+
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glDeleteBuffers(1, &VBO);
+}
+
+int main(int argc, char **argv)
+{
+	int maxSize = 4096;
+	std::string resultsFile;
+
+	for (int i = 1; i < argc; i++)
+	{
+		auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : ""; };
+
+		if (strcmp(argv[i], "--max-size") == 0)
+			maxSize = atoi(value());
+		else if (strcmp(argv[i], "--filter") == 0)
+			filter = value();
+		else if (strcmp(argv[i], "--results") == 0)
+			resultsFile = value();
+		else
+			std::cout << "Unknown option " << argv[i] << std::endl;
+	}
+
+	HeadlessContext context;
+	bool gl = context.init(64, 64) == 0;
+	if (!gl)
+		std::cout << "no GL context, upload benchmarks skipped" << std::endl;
+
+	noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+	noise.SetFractalType(FastNoiseLite::FractalType_Ridged);
+	noise.SetFractalOctaves(6);
+
+	for (int size : MESHBENCH_SIZES)
+	{
+		if (size > maxSize)
+			break;
+
+		MeshInput input = generateInput(size);
+		MeshData mesh;
+
+		benchmarkIndices(size);
+		benchmarkNormals(input, mesh);
+		benchmarkPacking(input, mesh);
+
+		if (gl)
+			benchmarkUploads(mesh, size);
+	}
+
+	if (gl)
+		context.terminate();
+
+	if (!resultsFile.empty() && !results.write(resultsFile))
+		return -1;
+
+	return 0;
+}
@@ -0,0 +1,381 @@
+// standalone FastNoiseLite throughput benchmark. it doesn't touch GL or GLFW, so it
+// builds and runs anywhere:
+//   g++ -std=c++17 -O2 noisebench.cpp -o noisebench
+//   ./noisebench [--quick] [--filter perlin_fbm] [--isa avx2] [--results noise.json]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "fastnoise.h"
+#include "noisedispatch.h"
+#include "benchmark.h"
+
+// warm runs loop over this many samples, small enough to stay in L1 with the coordinates
+const int NOISEBENCH_WARM_SAMPLES = 4096;
+// cold runs evict the caches and then time a single pass over this many samples
+const int NOISEBENCH_COLD_SAMPLES = 16384;
+// written before every cold pass, larger than any last level cache
+const size_t NOISEBENCH_EVICT_BYTES = 64 << 20;
+
+// warm runs repeat for at least this long, the median of the repeats is reported
+const double NOISEBENCH_MIN_MS = 20.0;
+const int NOISEBENCH_REPEATS = 5;
+
+const float NOISEBENCH_RANGE = 1000.0f; // coordinates in -range...range
+
+const FastNoiseLite::NoiseType NOISE_TYPES[] = {
+	FastNoiseLite::NoiseType_OpenSimplex2,
+	FastNoiseLite::NoiseType_OpenSimplex2S,
+	FastNoiseLite::NoiseType_Cellular,
+	FastNoiseLite::NoiseType_Perlin,
+	FastNoiseLite::NoiseType_ValueCubic,
+	FastNoiseLite::NoiseType_Value};
+
+// the domain warp fractal types only apply to DomainWarp(...), not GetNoise(...)
+const FastNoiseLite::FractalType FRACTAL_TYPES[] = {
+	FastNoiseLite::FractalType_None,
+	FastNoiseLite::FractalType_FBm,
+	FastNoiseLite::FractalType_Ridged,
+	FastNoiseLite::FractalType_PingPong};
+
+enum NoiseApi
+{
+	API_SCALAR,
+	API_BATCH,
+	API_GRID,
+	API_DISPATCH, // GetNoiseGrid through the vectorized kernels, 2D only
+	API_LOD, // the same with octaves dropped for NOISEBENCH_LOD_FOOTPRINT, 2D only
+	API_WARPED, // GetNoiseWarpedGrid through the vectorized kernels with warpNoise, 2D only
+	API_LAYERS, // getNoiseGridLayers with NOISEBENCH_LAYERS seeds, per point for all of them, 2D only
+	API_CHUNK, // getNoiseGridChunk relative to NOISEBENCH_CHUNK_ORIGIN, 2D only
+	API_COUNT
+};
+
+const char *const NOISE_API_NAMES[API_COUNT] = {"scalar", "batch", "grid", "dispatch", "lod", "warped", "layers", "chunk"};
+
+// a distant chunk, keeps about 3.6 octaves at the default frequency
+const float NOISEBENCH_LOD_FOOTPRINT = 8.0f;
+
+NoiseDispatch noiseDispatch;
+
+// height, moisture and temperature
+const int NOISEBENCH_LAYERS = 3;
+
+// a long haul flight away, float world coordinates are 0.5 apart out here
+const int NOISEBENCH_CHUNK_ORIGIN = 8000000;
+
+// the warp main.cpp uses for --warp 20
+FastNoiseLite warpNoise;
+
+// keeps the scalar loop from being optimized away
+volatile float sink;
+
+std::vector<char> evictBuffer;
+
+// fixed seed, every run measures the same coordinates
+std::vector<float> randomCoordinates(int count, unsigned int seed)
+{
+	std::vector<float> coordinates(count);
+	for (float &coordinate : coordinates)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		coordinate = ((seed >> 8) / 16777216.0f * 2.0f - 1.0f) * NOISEBENCH_RANGE;
+	}
+	return coordinates;
+}
+
+void evictCaches()
+{
+	evictBuffer.resize(NOISEBENCH_EVICT_BYTES);
+	for (size_t i = 0; i < evictBuffer.size(); i += 64)
+		evictBuffer[i]++;
+}
+
+// one pass of up to count samples through the given API, returns the samples computed
+int runPass(const FastNoiseLite &noise, int dimensions, NoiseApi api, int count,
+			 const float *x, const float *y, const float *z, float *out)
+{
+	switch (api)
+	{
+	case API_SCALAR:
+	{
+		float sum = 0.0f;
+		if (dimensions == 2)
+			for (int i = 0; i < count; i++)
+				sum += noise.GetNoise(x[i], y[i]);
+		else
+			for (int i = 0; i < count; i++)
+				sum += noise.GetNoise(x[i], y[i], z[i]);
+		sink = sum;
+		return count;
+	}
+
+	case API_BATCH:
+		if (dimensions == 2)
+			noise.GetNoiseBatch(x, y, out, count);
+		else
+			noise.GetNoiseBatch(x, y, z, out, count);
+		return count;
+
+	case API_DISPATCH:
+	{
+		int side = (int)std::sqrt((double)count);
+		noiseDispatch.getNoiseGrid(noise, x[0], y[0], 1.0f, side, count / side, out);
+		return side * (count / side);
+	}
+
+	case API_LOD:
+	{
+		int side = (int)std::sqrt((double)count);
+		noiseDispatch.getNoiseGridLod(noise, x[0], y[0], 1.0f, side, count / side, NOISEBENCH_LOD_FOOTPRINT, out);
+		return side * (count / side);
+	}
+
+	case API_WARPED:
+	{
+		int side = (int)std::sqrt((double)count);
+		noiseDispatch.getNoiseWarpedGrid(noise, warpNoise, x[0], y[0], 1.0f, side, count / side, out);
+		return side * (count / side);
+	}
+
+	case API_LAYERS:
+	{
+		static std::vector<float> layerOut((NOISEBENCH_LAYERS - 1) * NOISEBENCH_COLD_SAMPLES);
+		int side = (int)std::sqrt((double)count);
+		int seeds[NOISEBENCH_LAYERS];
+		float *outs[NOISEBENCH_LAYERS];
+		for (int layer = 0; layer < NOISEBENCH_LAYERS; layer++)
+		{
+			seeds[layer] = noise.GetSeed() + layer * 100;
+			outs[layer] = layer == 0 ? out : &layerOut[(layer - 1) * NOISEBENCH_COLD_SAMPLES];
+		}
+		noiseDispatch.getNoiseGridLayers(noise, seeds, NOISEBENCH_LAYERS, x[0], y[0], 1.0f, side, count / side, outs);
+		return side * (count / side);
+	}
+
+	case API_CHUNK:
+	{
+		int side = (int)std::sqrt((double)count);
+		noiseDispatch.getNoiseGridChunk(noise, NOISEBENCH_CHUNK_ORIGIN, -NOISEBENCH_CHUNK_ORIGIN, x[0], y[0], 1.0f, side, count / side, 0.0f, out);
+		return side * (count / side);
+	}
+
+	default:
+		// square and cube grids with count points, one unit apart
+		if (dimensions == 2)
+		{
+			int side = (int)std::sqrt((double)count);
+			noise.GetNoiseGrid(x[0], y[0], 1.0f, side, count / side, out);
+			return side * (count / side);
+		}
+		else
+		{
+			int side = (int)std::cbrt((double)count);
+			noise.GetNoiseGrid(x[0], y[0], z[0], 1.0f, side, side, count / (side * side), out);
+			return side * side * (count / (side * side));
+		}
+	}
+}
+
+// the kernels must reproduce the scalar generator exactly. each 2D dispatch API is
+// checked against its scalar counterpart, the chunk at origin 0 against the LOD grid
+bool matchesScalar(const FastNoiseLite &noise, NoiseApi api)
+{
+	const int side = 61; // not a multiple of any vector width
+	const float xStart = -123.4f, yStart = 56.7f, step = 0.37f;
+	std::vector<float> expected(side * side), actual(side * side);
+
+	switch (api)
+	{
+	case API_DISPATCH:
+		noise.GetNoiseGrid(xStart, yStart, step, side, side, &expected[0]);
+		noiseDispatch.getNoiseGrid(noise, xStart, yStart, step, side, side, &actual[0]);
+		return expected == actual;
+
+	case API_LOD:
+		for (int y = 0; y < side; y++)
+			for (int x = 0; x < side; x++)
+				expected[y * side + x] = noise.GetNoiseLod(xStart + x * step, yStart + y * step, NOISEBENCH_LOD_FOOTPRINT);
+		noiseDispatch.getNoiseGridLod(noise, xStart, yStart, step, side, side, NOISEBENCH_LOD_FOOTPRINT, &actual[0]);
+		return expected == actual;
+
+	case API_WARPED:
+		noise.GetNoiseWarpedGrid(warpNoise, xStart, yStart, step, side, side, &expected[0]);
+		noiseDispatch.getNoiseWarpedGrid(noise, warpNoise, xStart, yStart, step, side, side, &actual[0]);
+		return expected == actual;
+
+	case API_LAYERS:
+	{
+		std::vector<float> layerOut(NOISEBENCH_LAYERS * side * side);
+		int seeds[NOISEBENCH_LAYERS];
+		float *outs[NOISEBENCH_LAYERS];
+		for (int layer = 0; layer < NOISEBENCH_LAYERS; layer++)
+		{
+			seeds[layer] = noise.GetSeed() + layer * 100;
+			outs[layer] = &layerOut[layer * side * side];
+		}
+		noiseDispatch.getNoiseGridLayers(noise, seeds, NOISEBENCH_LAYERS, xStart, yStart, step, side, side, outs);
+
+		FastNoiseLite seeded = noise;
+		for (int layer = 0; layer < NOISEBENCH_LAYERS; layer++)
+		{
+			seeded.SetSeed(seeds[layer]);
+			seeded.GetNoiseGrid(xStart, yStart, step, side, side, &expected[0]);
+			if (!std::equal(expected.begin(), expected.end(), outs[layer]))
+				return false;
+		}
+		return true;
+	}
+
+	case API_CHUNK:
+		for (float footprint : {0.0f, NOISEBENCH_LOD_FOOTPRINT})
+		{
+			noiseDispatch.getNoiseGridLod(noise, xStart, yStart, step, side, side, footprint, &expected[0]);
+			noiseDispatch.getNoiseGridChunk(noise, 0, 0, xStart, yStart, step, side, side, footprint, &actual[0]);
+			if (expected != actual)
+				return false;
+		}
+		return true;
+
+	default:
+		return true;
+	}
+}
+
+// nanoseconds per sample, median of NOISEBENCH_REPEATS repeats
+double measure(const FastNoiseLite &noise, int dimensions, NoiseApi api, bool cold, int repeats)
+{
+	static const std::vector<float> x = randomCoordinates(NOISEBENCH_COLD_SAMPLES, 1);
+	static const std::vector<float> y = randomCoordinates(NOISEBENCH_COLD_SAMPLES, 2);
+	static const std::vector<float> z = randomCoordinates(NOISEBENCH_COLD_SAMPLES, 3);
+	static std::vector<float> out(NOISEBENCH_COLD_SAMPLES);
+
+	std::vector<double> times;
+	for (int repeat = 0; repeat < repeats; repeat++)
+	{
+		int samples = cold ? NOISEBENCH_COLD_SAMPLES : NOISEBENCH_WARM_SAMPLES;
+		long long total = 0;
+
+		if (cold)
+			evictCaches();
+		else
+			runPass(noise, dimensions, api, samples, &x[0], &y[0], &z[0], &out[0]);
+
+		auto start = std::chrono::steady_clock::now();
+		double elapsed = 0.0;
+		do
+		{
+			total += runPass(noise, dimensions, api, samples, &x[0], &y[0], &z[0], &out[0]);
+			elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		} while (!cold && elapsed < NOISEBENCH_MIN_MS);
+
+		times.push_back(elapsed * 1e6 / total);
+	}
+
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+int main(int argc, char **argv)
+{
+	bool quick = false;
+	std::string filter;
+	std::string resultsFile;
+	std::string isa;
+
+	for (int i = 1; i < argc; i++)
+	{
+		auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : ""; };
+
+		if (strcmp(argv[i], "--quick") == 0)
+			quick = true;
+		else if (strcmp(argv[i], "--filter") == 0)
+			filter = value();
+		else if (strcmp(argv[i], "--results") == 0)
+			resultsFile = value();
+		else if (strcmp(argv[i], "--isa") == 0)
+			isa = value();
+		else
+			std::cout << "Unknown option " << argv[i] << std::endl;
+	}
+
+	// --quick: one octave count per fractal type and fewer repeats
+	std::vector<int> octaveCounts = quick ? std::vector<int>{6} : std::vector<int>{3, 6, 8};
+	int repeats = quick ? 3 : NOISEBENCH_REPEATS;
+
+	noiseDispatch.init(isa);
+	warpNoise.SetFrequency(0.005f);
+	warpNoise.SetDomainWarpType(FastNoiseLite::DomainWarpType_BasicGrid);
+	warpNoise.SetDomainWarpAmp(20.0f);
+	warpNoise.SetFractalType(FastNoiseLite::FractalType_DomainWarpProgressive);
+	warpNoise.SetFractalOctaves(3);
+	std::cout << "dispatch: " << NOISE_ISA_NAMES[noiseDispatch.getIsa()] << " kernels" << std::endl;
+
+	BenchmarkResults results("noise");
+	int mismatches = 0;
+
+	for (size_t noiseType = 0; noiseType < sizeof(NOISE_TYPES) / sizeof(NOISE_TYPES[0]); noiseType++)
+	{
+		for (size_t fractalType = 0; fractalType < sizeof(FRACTAL_TYPES) / sizeof(FRACTAL_TYPES[0]); fractalType++)
+		{
+			// octaves don't matter without a fractal
+			std::vector<int> octaves = fractalType == 0 ? std::vector<int>{1} : octaveCounts;
+
+			for (int octaveCount : octaves)
+			{
+				FastNoiseLite noise;
+				noise.SetNoiseType(NOISE_TYPES[noiseType]);
+				noise.SetFractalType(FRACTAL_TYPES[fractalType]);
+				noise.SetFractalOctaves(octaveCount);
+
+				for (int dimensions = 2; dimensions <= 3; dimensions++)
+				{
+					for (int api = 0; api < API_COUNT; api++)
+					{
+						if ((api == API_DISPATCH || api == API_LOD || api == API_WARPED || api == API_LAYERS || api == API_CHUNK) && dimensions != 2)
+							continue;
+
+						for (int cold = 0; cold <= 1; cold++)
+						{
+							std::string name = std::string(NOISE_TYPE_NAMES[noiseType]) + "_" + FRACTAL_TYPE_NAMES[fractalType] + "_" +
+											   std::to_string(octaveCount) + "oct_" + std::to_string(dimensions) + "d_" +
+											   NOISE_API_NAMES[api] + (cold ? "_cold" : "_warm");
+
+							if (name.find(filter) == std::string::npos)
+								continue;
+
+							if (dimensions == 2 && !cold && !matchesScalar(noise, (NoiseApi)api))
+							{
+								std::cout << name << ": differs from the scalar generator" << std::endl;
+								mismatches++;
+							}
+
+							double nanoseconds = measure(noise, dimensions, (NoiseApi)api, cold, repeats);
+							double samplesPerSecond = 1e9 / nanoseconds;
+
+							std::cout << name << ": " << nanoseconds << " ns/sample, " << samplesPerSecond / 1e6 << " Msamples/s" << std::endl;
+
+							results.add(name + "_ns_per_sample", nanoseconds);
+							results.add(name + "_samples_per_s", samplesPerSecond);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// any mismatch fails the run, and benchstore flags it against a clean baseline
+	results.add("scalar_mismatches", mismatches);
+	if (mismatches > 0)
+		std::cout << mismatches << " kernel configurations differ from the scalar generator" << std::endl;
+
+	if (!resultsFile.empty() && !results.write(resultsFile))
+		return -1;
+
+	return mismatches > 0 ? -1 : 0;
+}
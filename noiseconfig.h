@@ -0,0 +1,171 @@
+#ifndef NOISECONFIG_H
+#define NOISECONFIG_H
+
+// frozen noise settings. nothing can change a NoiseConfig after build() and all of its
+// evaluation is const, so any number of threads can share one without locks. changes go
+// through a NoiseConfigBuilder, which produces a new config:
+//   noise = noise.edit().fractalOctaves(8).build();
+
+#include <type_traits>
+
+#include "fastnoise.h"
+
+class NoiseConfigBuilder;
+
+class NoiseConfig
+{
+private:
+	// holds the derived state too (fractal bounding, transform types), copied as is
+	FastNoiseLite noise;
+
+	explicit NoiseConfig(const FastNoiseLite &noise) : noise(noise) {}
+
+	friend class NoiseConfigBuilder;
+
+public:
+	NoiseConfig() = default;
+
+	// getters and const evaluation, for everything that takes a const FastNoiseLite &
+	const FastNoiseLite &get() const
+	{
+		return noise;
+	}
+
+	float getNoise(float x, float y) const
+	{
+		return noise.GetNoise(x, y);
+	}
+
+	float getNoise(float x, float y, float z) const
+	{
+		return noise.GetNoise(x, y, z);
+	}
+
+	void getNoiseGrid(float xStart, float yStart, float step, int width, int height, float *out) const
+	{
+		noise.GetNoiseGrid(xStart, yStart, step, width, height, out);
+	}
+
+	// a builder starting from these settings
+	NoiseConfigBuilder edit() const;
+};
+
+static_assert(std::is_trivially_copyable<NoiseConfig>::value, "NoiseConfig must stay trivially copyable");
+
+class NoiseConfigBuilder
+{
+private:
+	FastNoiseLite noise;
+
+public:
+	NoiseConfigBuilder() = default;
+	explicit NoiseConfigBuilder(const NoiseConfig &config) : noise(config.get()) {}
+
+	NoiseConfigBuilder &seed(int seed)
+	{
+		noise.SetSeed(seed);
+		return *this;
+	}
+
+	NoiseConfigBuilder &frequency(float frequency)
+	{
+		noise.SetFrequency(frequency);
+		return *this;
+	}
+
+	NoiseConfigBuilder &noiseType(FastNoiseLite::NoiseType noiseType)
+	{
+		noise.SetNoiseType(noiseType);
+		return *this;
+	}
+
+	NoiseConfigBuilder &rotationType3D(FastNoiseLite::RotationType3D rotationType3D)
+	{
+		noise.SetRotationType3D(rotationType3D);
+		return *this;
+	}
+
+	NoiseConfigBuilder &fractalType(FastNoiseLite::FractalType fractalType)
+	{
+		noise.SetFractalType(fractalType);
+		return *this;
+	}
+
+	NoiseConfigBuilder &fractalOctaves(int octaves)
+	{
+		noise.SetFractalOctaves(octaves);
+		return *this;
+	}
+
+	NoiseConfigBuilder &fractalLacunarity(float lacunarity)
+	{
+		noise.SetFractalLacunarity(lacunarity);
+		return *this;
+	}
+
+	NoiseConfigBuilder &fractalGain(float gain)
+	{
+		noise.SetFractalGain(gain);
+		return *this;
+	}
+
+	NoiseConfigBuilder &fractalWeightedStrength(float weightedStrength)
+	{
+		noise.SetFractalWeightedStrength(weightedStrength);
+		return *this;
+	}
+
+	NoiseConfigBuilder &fractalPingPongStrength(float pingPongStrength)
+	{
+		noise.SetFractalPingPongStrength(pingPongStrength);
+		return *this;
+	}
+
+	NoiseConfigBuilder &fractalLodThreshold(float lodThreshold)
+	{
+		noise.SetFractalLodThreshold(lodThreshold);
+		return *this;
+	}
+
+	NoiseConfigBuilder &cellularDistanceFunction(FastNoiseLite::CellularDistanceFunction cellularDistanceFunction)
+	{
+		noise.SetCellularDistanceFunction(cellularDistanceFunction);
+		return *this;
+	}
+
+	NoiseConfigBuilder &cellularReturnType(FastNoiseLite::CellularReturnType cellularReturnType)
+	{
+		noise.SetCellularReturnType(cellularReturnType);
+		return *this;
+	}
+
+	NoiseConfigBuilder &cellularJitter(float cellularJitter)
+	{
+		noise.SetCellularJitter(cellularJitter);
+		return *this;
+	}
+
+	NoiseConfigBuilder &domainWarpType(FastNoiseLite::DomainWarpType domainWarpType)
+	{
+		noise.SetDomainWarpType(domainWarpType);
+		return *this;
+	}
+
+	NoiseConfigBuilder &domainWarpAmp(float domainWarpAmp)
+	{
+		noise.SetDomainWarpAmp(domainWarpAmp);
+		return *this;
+	}
+
+	NoiseConfig build() const
+	{
+		return NoiseConfig(noise);
+	}
+};
+
+inline NoiseConfigBuilder NoiseConfig::edit() const
+{
+	return NoiseConfigBuilder(*this);
+}
+
+#endif
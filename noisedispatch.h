@@ -0,0 +1,1370 @@
+#ifndef NOISEDISPATCH_H
+#define NOISEDISPATCH_H
+
+// vectorized FastNoiseLite grid kernels, picked at startup from the instruction sets the
+// CPU has so one binary runs on every x86-64 host without -mavx2. mirrors the generator
+// through its getters like the compute shader does and matches GetNoiseGrid bit for bit.
+// 2D Perlin, Value and Cellular are vectorized, every other noise type (and non x86 or
+// non GCC builds) goes through the scalar FastNoiseLite::GetNoiseGrid. the BasicGrid
+// domain warp is vectorized too, on its own or fused with the noise so warped points
+// never hit memory. chunks at an integer origin keep float kernels far from the world
+// origin without losing precision
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "fastnoise.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NOISE_DISPATCH_X86 1
+#else
+#define NOISE_DISPATCH_X86 0
+#endif
+
+enum NoiseIsa
+{
+	NOISE_ISA_SCALAR,
+	NOISE_ISA_SSE2,
+	NOISE_ISA_AVX2,
+	NOISE_ISA_AVX512,
+	NOISE_ISA_COUNT
+};
+
+const char *const NOISE_ISA_NAMES[NOISE_ISA_COUNT] = {"scalar", "sse2", "avx2", "avx512"};
+
+// indexed by FastNoiseLite::NoiseType and FastNoiseLite::FractalType
+const char *const NOISE_TYPE_NAMES[] = {"opensimplex2", "opensimplex2s", "cellular", "perlin", "valuecubic", "value"};
+const char *const FRACTAL_TYPE_NAMES[] = {"none", "fbm", "ridged", "pingpong", "domainwarpprogressive", "domainwarpindependent"};
+
+// octaves a chunk origin is split for, noise with more takes the plain float grid
+const int NOISE_CHUNK_OCTAVES = 16;
+
+// an integer world origin in each octave's lattice: the whole cells, added to the hashed
+// lattice indices, and the fraction of a cell left over, added to the chunk relative
+// coordinates. see NoiseDispatch::getNoiseGridChunk
+struct NoiseChunkOrigin
+{
+	int xCell[NOISE_CHUNK_OCTAVES];
+	int yCell[NOISE_CHUNK_OCTAVES];
+	float x[NOISE_CHUNK_OCTAVES];
+	float y[NOISE_CHUNK_OCTAVES];
+};
+
+// the generator settings a kernel reads, copied once per call
+struct NoiseKernelParams
+{
+	int seed;
+	float frequency;
+	int octaves;
+	float lacunarity;
+	float gain;
+	float weightedStrength;
+	float bounding;
+	float pingPongStrength;
+	float lodOctaves; // GetFractalOctavesForFootprint, the octave count without LOD
+	int cellularDistanceFunction;
+	int cellularReturnType;
+	float cellularJitter;
+	const NoiseChunkOrigin *origin; // NULL, or the origin grid coordinates are relative to
+};
+
+// same layout as FastNoiseLite::GetNoiseGrid, out[y * width + x]
+typedef void (*NoiseGridKernel)(const NoiseKernelParams &params, float xStart, float yStart, float step, int width, int height, float *out);
+
+// seeds evaluated in one pass by a layers kernel, more go through several passes
+const int NOISE_MAX_LAYERS = 4;
+
+// the grid once per seed, out[layer][y * width + x]. params.seed is ignored
+typedef void (*NoiseLayersKernel)(const NoiseKernelParams &params, const int *seeds, int layers, float xStart, float yStart, float step, int width,
+								  int height, float *const *out);
+
+// the domain warp settings of a generator, see FastNoiseLite::DomainWarp
+struct NoiseWarpParams
+{
+	int seed;
+	float frequency;
+	int octaves;
+	float lacunarity;
+	float gain;
+	float amp; // domain warp amp times the fractal bounding
+};
+
+// where warped noise is evaluated: count points from x and y, or a grid like GetNoiseGrid
+// when x is NULL
+struct NoisePoints
+{
+	const float *x;
+	const float *y;
+	int count;
+
+	float xStart;
+	float yStart;
+	float step;
+	int width;
+	int height;
+};
+
+typedef void (*NoiseWarpedKernel)(const NoiseKernelParams &params, const NoiseWarpParams &warp, const NoisePoints &points, float *out);
+
+// warps count points in place
+typedef void (*NoiseWarpKernel)(const NoiseWarpParams &warp, float *x, float *y, int count);
+
+#if NOISE_DISPATCH_X86
+
+// everything below is inlined into the target("...") entry points, so the same source
+// compiles to SSE2, AVX2 or AVX-512 depending on the caller
+#define NOISE_INLINE inline __attribute__((always_inline))
+
+// the helpers below are always inlined, their AVX vectors never cross an ABI boundary.
+// arguments go by reference, GCC reports -Wpsabi for returns at the end of the
+// translation unit, so it stays off
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// GCC vector extension types of N lanes, vector_size can't depend on a template parameter
+template <int N>
+struct NoiseVectors;
+
+template <>
+struct NoiseVectors<4>
+{
+	typedef float Float __attribute__((vector_size(16)));
+	typedef int Int __attribute__((vector_size(16)));
+	typedef unsigned int Uint __attribute__((vector_size(16)));
+};
+
+template <>
+struct NoiseVectors<8>
+{
+	typedef float Float __attribute__((vector_size(32)));
+	typedef int Int __attribute__((vector_size(32)));
+	typedef unsigned int Uint __attribute__((vector_size(32)));
+};
+
+template <>
+struct NoiseVectors<16>
+{
+	typedef float Float __attribute__((vector_size(64)));
+	typedef int Int __attribute__((vector_size(64)));
+	typedef unsigned int Uint __attribute__((vector_size(64)));
+};
+
+// N lanes at a time. the expressions follow FastNoiseLite operation for operation and
+// nothing gets contracted into FMAs, so every lane matches GetNoise exactly
+template <int N>
+struct NoiseLanes
+{
+	typedef typename NoiseVectors<N>::Float Float;
+	typedef typename NoiseVectors<N>::Int Int;
+	typedef typename NoiseVectors<N>::Uint Uint;
+
+	static const int PrimeX = 501125321;
+	static const int PrimeY = 1136930381;
+
+	// FastFloor, including its off by one on negative integers
+	static NOISE_INLINE Int fastFloor(const Float &f)
+	{
+		return __builtin_convertvector(f, Int) + (Int)(f < 0.0f);
+	}
+
+	static NOISE_INLINE int fastFloor(float f)
+	{
+		return f >= 0 ? (int)f : (int)f - 1;
+	}
+
+	static NOISE_INLINE Float lerp(const Float &a, const Float &b, const Float &t)
+	{
+		return a + t * (b - a);
+	}
+
+	static NOISE_INLINE Float lerp(const Float &a, const Float &b, float t)
+	{
+		return a + t * (b - a);
+	}
+
+	static NOISE_INLINE Float toFloat(const Int &i)
+	{
+		return __builtin_convertvector(i, Float);
+	}
+
+	static NOISE_INLINE float toFloat(int i)
+	{
+		return (float)i;
+	}
+
+	// coordinate times a prime, wrapping like the scalar int overflow does in practice
+	static NOISE_INLINE Uint primed(const Int &i, int prime)
+	{
+		return (Uint)i * (unsigned int)prime;
+	}
+
+	static NOISE_INLINE unsigned int primed(int i, int prime)
+	{
+		return (unsigned int)i * prime;
+	}
+
+	// the hash is an unsigned multiply too. y is a single row (unsigned int) on grids and
+	// per lane (Uint) once the points are warped, the same goes for the functions below
+	template <typename YPrimed>
+	static NOISE_INLINE Int hash(int seed, const Uint &xPrimed, const YPrimed &yPrimed)
+	{
+		Uint h = ((unsigned int)seed ^ xPrimed ^ yPrimed) * 0x27d4eb2du;
+		return (Int)h;
+	}
+
+	// the x y pair at each lane's (even) index. the pairs are loaded 8 bytes at a time into
+	// plain arrays and split with shuffles, GCC inserts lanes one at a time when indexing
+	// vectors directly
+	static NOISE_INLINE void gather(const float *table, const Int &index, Float &x, Float &y)
+	{
+		unsigned long long pairs[N];
+		int indices[N];
+		memcpy(indices, &index, sizeof(indices));
+		for (int lane = 0; lane < N; lane++)
+			memcpy(&pairs[lane], table + indices[lane], sizeof(pairs[lane]));
+
+		Float low, high;
+		memcpy(&low, pairs, sizeof(low));
+		memcpy(&high, pairs + N / 2, sizeof(high));
+		Int even, odd;
+		for (int lane = 0; lane < N; lane++)
+		{
+			even[lane] = lane * 2;
+			odd[lane] = lane * 2 + 1;
+		}
+		x = __builtin_shuffle(low, high, even);
+		y = __builtin_shuffle(low, high, odd);
+	}
+
+	template <typename YPrimed, typename Y>
+	static NOISE_INLINE Float gradCoord(int seed, const Uint &xPrimed, const YPrimed &yPrimed, const Float &xd, const Y &yd)
+	{
+		Int h = hash(seed, xPrimed, yPrimed);
+		h ^= h >> 15;
+		h &= 127 << 1;
+
+		Float xg, yg;
+		gather(FastNoiseLite::GetGradients2D(), h, xg, yg);
+
+		return xd * xg + yd * yg;
+	}
+
+	template <typename YPrimed>
+	static NOISE_INLINE Float valCoord(int seed, const Uint &xPrimed, const YPrimed &yPrimed)
+	{
+		Uint h = (Uint)hash(seed, xPrimed, yPrimed);
+		h *= h;
+		h ^= h << 19;
+		return __builtin_convertvector((Int)h, Float) * (1 / 2147483648.0f);
+	}
+
+	// the lattice cell, offsets, fade weights and primed coordinates only depend on the
+	// point, so several seeds share them and only hash on their own. xCell and yCell are
+	// whole cells added to the hashed indices, see NoiseChunkOrigin
+	template <typename Y>
+	static NOISE_INLINE void perlinLayers(const int *seeds, int layers, const Float &x, const Y &y, Float *noise, int xCell = 0, int yCell = 0)
+	{
+		Int x0 = fastFloor(x);
+		auto y0 = fastFloor(y);
+
+		Float xd0 = x - toFloat(x0);
+		Y yd0 = y - toFloat(y0);
+		Float xd1 = xd0 - 1.0f;
+		Y yd1 = yd0 - 1.0f;
+
+		Float xs = xd0 * xd0 * xd0 * (xd0 * (xd0 * 6.0f - 15.0f) + 10.0f);
+		Y ys = yd0 * yd0 * yd0 * (yd0 * (yd0 * 6.0f - 15.0f) + 10.0f);
+
+		Uint x0p = primed(x0, PrimeX) + primed(xCell, PrimeX);
+		auto y0p = primed(y0, PrimeY) + primed(yCell, PrimeY);
+		Uint x1p = x0p + (unsigned int)PrimeX;
+		auto y1p = y0p + (unsigned int)PrimeY;
+
+		for (int layer = 0; layer < layers; layer++)
+		{
+			int seed = seeds[layer];
+			Float xf0 = lerp(gradCoord(seed, x0p, y0p, xd0, yd0), gradCoord(seed, x1p, y0p, xd1, yd0), xs);
+			Float xf1 = lerp(gradCoord(seed, x0p, y1p, xd0, yd1), gradCoord(seed, x1p, y1p, xd1, yd1), xs);
+
+			noise[layer] = lerp(xf0, xf1, ys) * 1.4247691104677813f;
+		}
+	}
+
+	template <typename Y>
+	static NOISE_INLINE void valueLayers(const int *seeds, int layers, const Float &x, const Y &y, Float *noise, int xCell = 0, int yCell = 0)
+	{
+		Int x0 = fastFloor(x);
+		auto y0 = fastFloor(y);
+
+		Float xt = x - toFloat(x0);
+		Y yt = y - toFloat(y0);
+		Float xs = xt * xt * (3.0f - 2.0f * xt);
+		Y ys = yt * yt * (3.0f - 2.0f * yt);
+
+		Uint x0p = primed(x0, PrimeX) + primed(xCell, PrimeX);
+		auto y0p = primed(y0, PrimeY) + primed(yCell, PrimeY);
+		Uint x1p = x0p + (unsigned int)PrimeX;
+		auto y1p = y0p + (unsigned int)PrimeY;
+
+		for (int layer = 0; layer < layers; layer++)
+		{
+			int seed = seeds[layer];
+			Float xf0 = lerp(valCoord(seed, x0p, y0p), valCoord(seed, x1p, y0p), xs);
+			Float xf1 = lerp(valCoord(seed, x0p, y1p), valCoord(seed, x1p, y1p), xs);
+
+			noise[layer] = lerp(xf0, xf1, ys);
+		}
+	}
+
+	template <typename Y>
+	static NOISE_INLINE Float perlin(int seed, const Float &x, const Y &y)
+	{
+		Float noise;
+		perlinLayers(&seed, 1, x, y, &noise);
+		return noise;
+	}
+
+	template <typename Y>
+	static NOISE_INLINE Float value(int seed, const Float &x, const Y &y)
+	{
+		Float noise;
+		valueLayers(&seed, 1, x, y, &noise);
+		return noise;
+	}
+
+	static NOISE_INLINE Int fastRound(const Float &f)
+	{
+		return __builtin_convertvector(f >= 0.0f ? f + 0.5f : f - 0.5f, Int);
+	}
+
+	static NOISE_INLINE int fastRound(float f)
+	{
+		return f >= 0 ? (int)(f + 0.5f) : (int)(f - 0.5f);
+	}
+
+	static NOISE_INLINE Float absolute(const Float &f)
+	{
+		return f < 0.0f ? -f : f;
+	}
+
+	static NOISE_INLINE float absolute(float f)
+	{
+		return f < 0 ? -f : f;
+	}
+
+	static NOISE_INLINE bool allLanes(const Int &mask)
+	{
+		for (int lane = 0; lane < N; lane++)
+			if (!mask[lane])
+				return false;
+		return true;
+	}
+
+	static NOISE_INLINE Float positive(const Float &f)
+	{
+		return f < 0.0f ? Float{} : f;
+	}
+
+	static NOISE_INLINE float positive(float f)
+	{
+		return f < 0 ? 0.0f : f;
+	}
+
+	// FastNoiseLite's cellular distance of an offset. it grows with either axis, so the
+	// smallest possible offsets give a lower bound
+	template <int DISTANCE, typename Y>
+	static NOISE_INLINE Float cellularDistance(const Float &x, const Y &y)
+	{
+		if (DISTANCE == FastNoiseLite::CellularDistanceFunction_Manhattan)
+			return absolute(x) + absolute(y);
+		if (DISTANCE == FastNoiseLite::CellularDistanceFunction_Hybrid)
+			return (absolute(x) + absolute(y)) + (x * x + y * y);
+		return x * x + y * y;
+	}
+
+	// the distance of a cell's feature point from the cell offset, and the hash it was picked with
+	template <int DISTANCE, typename Y, typename YPrimed>
+	static NOISE_INLINE Float cellularFeature(float jitter, int seed, const Float &xd, const Y &yd, const Uint &xPrimed, const YPrimed &yPrimed, Int &h)
+	{
+		h = hash(seed, xPrimed, yPrimed);
+		Float xv, yv;
+		randVecs(h & (255 << 1), xv, yv);
+
+		return cellularDistance<DISTANCE>(xd + xv * jitter, yd + yv * jitter);
+	}
+
+	// FastNoiseLite::SingleCellular over the same 3x3 cells in the same order, keeping the
+	// closest two without branches. the centre cell goes first to get a distance to beat:
+	// a feature point is at most |jitter| from its cell (the random vectors are unit
+	// length) and a cell is skipped when that bound can't change the result on any lane
+	template <int DISTANCE, typename Y>
+	static NOISE_INLINE void cellularCells(const NoiseKernelParams &params, int seed, const Float &x, const Y &y, int xCell, int yCell,
+										   Float &distance0, Float &distance1, Int &closestHash)
+	{
+		Int xr = fastRound(x);
+		auto yr = fastRound(y);
+
+		float jitter = 0.43701595f * params.cellularJitter;
+		// slightly past the real reach, the bound has to hold after float rounding too
+		float reach = absolute(jitter) * 1.001f + 1e-4f;
+		bool second = params.cellularReturnType >= FastNoiseLite::CellularReturnType_Distance2;
+
+		Uint xPrimedBase = primed(xr - 1, PrimeX) + primed(xCell, PrimeX);
+		auto yPrimedBase = primed(yr - 1, PrimeY) + primed(yCell, PrimeY);
+
+		Int centreHash;
+		Float centre = cellularFeature<DISTANCE>(jitter, seed, toFloat(xr) - x, toFloat(yr) - y, xPrimedBase + (unsigned int)PrimeX,
+												 yPrimedBase + (unsigned int)PrimeY, centreHash);
+
+		distance0 = Float{} + 1e10f;
+		distance1 = Float{} + 1e10f;
+		closestHash = Int{};
+
+		Uint xPrimed = xPrimedBase;
+		for (int i = -1; i <= 1; i++)
+		{
+			Float xd = toFloat(xr + i) - x;
+			Float xMin = positive(absolute(xd) - reach);
+
+			auto yPrimed = yPrimedBase;
+			for (int j = -1; j <= 1; j++, yPrimed += (unsigned int)PrimeY)
+			{
+				Y yd = toFloat(yr + j) - y;
+				Float newDistance;
+				Int h;
+
+				if (i == 0 && j == 0)
+				{
+					newDistance = centre;
+					h = centreHash;
+				}
+				else
+				{
+					// the centre counts towards the closest two until it's been visited
+					Float beat = second ? distance1 : distance0;
+					if (i < 0 || (i == 0 && j < 0))
+					{
+						Float withCentre = second ? (distance0 > centre ? distance0 : centre) : centre;
+						beat = beat < withCentre ? beat : withCentre;
+					}
+
+					if (allLanes(cellularDistance<DISTANCE>(xMin, positive(absolute(yd) - reach)) > beat))
+						continue;
+
+					newDistance = cellularFeature<DISTANCE>(jitter, seed, xd, yd, xPrimed, yPrimed, h);
+				}
+
+				Float lower = distance1 < newDistance ? distance1 : newDistance;
+				distance1 = lower > distance0 ? lower : distance0;
+				Int closer = newDistance < distance0;
+				distance0 = closer ? newDistance : distance0;
+				closestHash = closer ? h : closestHash;
+			}
+			xPrimed += (unsigned int)PrimeX;
+		}
+	}
+
+	template <typename Y>
+	static NOISE_INLINE Float cellular(const NoiseKernelParams &params, int seed, const Float &x, const Y &y, int xCell = 0, int yCell = 0)
+	{
+		Float distance0, distance1;
+		Int closestHash;
+		switch (params.cellularDistanceFunction)
+		{
+		case FastNoiseLite::CellularDistanceFunction_Manhattan:
+			cellularCells<FastNoiseLite::CellularDistanceFunction_Manhattan>(params, seed, x, y, xCell, yCell, distance0, distance1, closestHash);
+			break;
+		case FastNoiseLite::CellularDistanceFunction_Hybrid:
+			cellularCells<FastNoiseLite::CellularDistanceFunction_Hybrid>(params, seed, x, y, xCell, yCell, distance0, distance1, closestHash);
+			break;
+		default:
+			cellularCells<FastNoiseLite::CellularDistanceFunction_EuclideanSq>(params, seed, x, y, xCell, yCell, distance0, distance1, closestHash);
+			break;
+		}
+
+		if (params.cellularDistanceFunction == FastNoiseLite::CellularDistanceFunction_Euclidean &&
+			params.cellularReturnType >= FastNoiseLite::CellularReturnType_Distance)
+		{
+			for (int lane = 0; lane < N; lane++)
+			{
+				distance0[lane] = sqrtf(distance0[lane]);
+				if (params.cellularReturnType >= FastNoiseLite::CellularReturnType_Distance2)
+					distance1[lane] = sqrtf(distance1[lane]);
+			}
+		}
+
+		switch (params.cellularReturnType)
+		{
+		case FastNoiseLite::CellularReturnType_CellValue:
+			return toFloat(closestHash) * (1 / 2147483648.0f);
+		case FastNoiseLite::CellularReturnType_Distance:
+			return distance0 - 1.0f;
+		case FastNoiseLite::CellularReturnType_Distance2:
+			return distance1 - 1.0f;
+		case FastNoiseLite::CellularReturnType_Distance2Add:
+			return (distance1 + distance0) * 0.5f - 1.0f;
+		case FastNoiseLite::CellularReturnType_Distance2Sub:
+			return distance1 - distance0 - 1.0f;
+		case FastNoiseLite::CellularReturnType_Distance2Mul:
+			return distance1 * distance0 * 0.5f - 1.0f;
+		case FastNoiseLite::CellularReturnType_Distance2Div:
+			return distance0 / distance1 - 1.0f;
+		default:
+			return Float{};
+		}
+	}
+
+	// cellular feature points depend on the seed, its layers only share the pass
+	template <int NOISE, typename Y>
+	static NOISE_INLINE void singleLayers(const NoiseKernelParams &params, const int *seeds, int layers, const Float &x, const Y &y, Float *noise,
+											  int xCell = 0, int yCell = 0)
+	{
+		if (NOISE == FastNoiseLite::NoiseType_Perlin)
+			perlinLayers(seeds, layers, x, y, noise, xCell, yCell);
+		else if (NOISE == FastNoiseLite::NoiseType_Value)
+			valueLayers(seeds, layers, x, y, noise, xCell, yCell);
+		else
+		{
+			for (int layer = 0; layer < layers; layer++)
+				noise[layer] = cellular(params, seeds[layer], x, y, xCell, yCell);
+		}
+	}
+
+	// octave i of singleLayers, moved to the chunk origin when there is one
+	template <int NOISE, typename Y>
+	static NOISE_INLINE void octaveLayers(const NoiseKernelParams &params, int i, const int *seeds, int layers, const Float &x, const Y &y, Float *noise)
+	{
+		const NoiseChunkOrigin *origin = params.origin;
+		if (origin)
+			singleLayers<NOISE>(params, seeds, layers, x + origin->x[i], y + origin->y[i], noise, origin->xCell[i], origin->yCell[i]);
+		else
+			singleLayers<NOISE>(params, seeds, layers, x, y, noise);
+	}
+
+	template <int NOISE, typename Y>
+	static NOISE_INLINE Float single(const NoiseKernelParams &params, int seed, const Float &x, const Y &y)
+	{
+		Float noise;
+		singleLayers<NOISE>(params, &seed, 1, x, y, &noise);
+		return noise;
+	}
+
+	// fractal() for up to NOISE_MAX_LAYERS seeds, each octave goes through octaveLayers.
+	// with an origin the position is relative to it, in noise units of the first octave
+	template <int NOISE, int FRACTAL, typename Y>
+	static NOISE_INLINE void fractalLayers(const NoiseKernelParams &params, const int *seeds, int layers, const Float &position, const Y &start, Float *out)
+	{
+		if (FRACTAL == FastNoiseLite::FractalType_None)
+		{
+			octaveLayers<NOISE>(params, 0, seeds, layers, position, start, out);
+			return;
+		}
+
+		Float x = position;
+		Y y = start;
+		int octaveSeeds[NOISE_MAX_LAYERS];
+		Float amps[NOISE_MAX_LAYERS];
+		for (int layer = 0; layer < layers; layer++)
+		{
+			octaveSeeds[layer] = seeds[layer];
+			amps[layer] = Float{} + params.bounding;
+			out[layer] = Float{};
+		}
+		Float one = Float{} + 1.0f;
+
+		// the octave after the full ones fades in, see FastNoiseLite::GenFractalLod
+		int full = (int)params.lodOctaves;
+		float t = params.lodOctaves - full;
+		float fade = t * t * (3 - 2 * t);
+		int count = full < params.octaves && fade > 0 ? full + 1 : full;
+
+		for (int i = 0; i < count; i++)
+		{
+			Float noises[NOISE_MAX_LAYERS];
+			octaveLayers<NOISE>(params, i, octaveSeeds, layers, x, y, noises);
+			float weight = i < full ? 1 : fade;
+
+			for (int layer = 0; layer < layers; layer++)
+			{
+				Float noise = noises[layer];
+				Float &sum = out[layer];
+				Float &amp = amps[layer];
+
+				if (FRACTAL == FastNoiseLite::FractalType_FBm)
+				{
+					sum += noise * amp * weight;
+					Float clamped = noise + 1.0f < 2.0f ? noise + 1.0f : Float{} + 2.0f;
+					amp *= lerp(one, clamped * 0.5f, params.weightedStrength);
+				}
+				else if (FRACTAL == FastNoiseLite::FractalType_Ridged)
+				{
+					noise = noise < 0.0f ? -noise : noise;
+					sum += (noise * -2.0f + 1.0f) * amp * weight;
+					amp *= lerp(one, 1.0f - noise, params.weightedStrength);
+				}
+				else
+				{
+					// PingPong((noise + 1) * strength)
+					Float t = (noise + 1.0f) * params.pingPongStrength;
+					t -= __builtin_convertvector(__builtin_convertvector(t * 0.5f, Int) * 2, Float);
+					noise = t < 1.0f ? t : 2.0f - t;
+					sum += (noise - 0.5f) * 2.0f * amp * weight;
+					amp *= lerp(one, noise, params.weightedStrength);
+				}
+
+				amp *= params.gain;
+				octaveSeeds[layer]++;
+			}
+
+			x *= params.lacunarity;
+			y *= params.lacunarity;
+		}
+	}
+
+	template <int NOISE, int FRACTAL, typename Y>
+	static NOISE_INLINE Float fractal(const NoiseKernelParams &params, const Float &position, const Y &start)
+	{
+		Float noise;
+		fractalLayers<NOISE, FRACTAL>(params, &params.seed, 1, position, start, &noise);
+		return noise;
+	}
+
+	template <int NOISE, int FRACTAL>
+	static NOISE_INLINE void gridLayers(const NoiseKernelParams &params, const int *seeds, int layers, float xStart, float yStart, float step,
+										int width, int height, float *const *out)
+	{
+		Int columns;
+		for (int lane = 0; lane < N; lane++)
+			columns[lane] = lane;
+
+		for (int row = 0; row < height; row++)
+		{
+			float y = (yStart + row * step) * params.frequency;
+
+			for (int column = 0; column < width; column += N)
+			{
+				Float x = xStart + __builtin_convertvector(columns + column, Float) * step;
+				Float noise[NOISE_MAX_LAYERS];
+				fractalLayers<NOISE, FRACTAL>(params, seeds, layers, x * params.frequency, y, noise);
+
+				int count = column + N <= width ? N : width - column;
+				for (int layer = 0; layer < layers; layer++)
+					memcpy(out[layer] + row * width + column, &noise[layer], count * sizeof(float));
+			}
+		}
+	}
+
+	template <int NOISE, int FRACTAL>
+	static NOISE_INLINE void grid(const NoiseKernelParams &params, float xStart, float yStart, float step, int width, int height, float *out)
+	{
+		gridLayers<NOISE, FRACTAL>(params, &params.seed, 1, xStart, yStart, step, width, height, &out);
+	}
+
+	// the two random vectors of each lane's hash
+	static NOISE_INLINE void randVecs(const Int &h, Float &x, Float &y)
+	{
+		gather(FastNoiseLite::GetRandVecs2D(), h, x, y);
+	}
+
+	// FastNoiseLite::SingleDomainWarpBasicGrid, adds the warp of (x, y) to (xr, yr)
+	static NOISE_INLINE void warpBasicGrid(int seed, float warpAmp, float frequency, const Float &x, const Float &y, Float &xr, Float &yr)
+	{
+		Float xf = x * frequency;
+		Float yf = y * frequency;
+
+		Int x0 = fastFloor(xf);
+		Int y0 = fastFloor(yf);
+
+		Float xt = xf - toFloat(x0);
+		Float yt = yf - toFloat(y0);
+		Float xs = xt * xt * (3.0f - 2.0f * xt);
+		Float ys = yt * yt * (3.0f - 2.0f * yt);
+
+		Uint x0p = primed(x0, PrimeX);
+		Uint y0p = primed(y0, PrimeY);
+		Uint x1p = x0p + (unsigned int)PrimeX;
+		Uint y1p = y0p + (unsigned int)PrimeY;
+
+		Float ax, ay, bx, by;
+		randVecs(hash(seed, x0p, y0p) & (255 << 1), ax, ay);
+		randVecs(hash(seed, x1p, y0p) & (255 << 1), bx, by);
+		Float lx0x = lerp(ax, bx, xs);
+		Float ly0x = lerp(ay, by, xs);
+
+		randVecs(hash(seed, x0p, y1p) & (255 << 1), ax, ay);
+		randVecs(hash(seed, x1p, y1p) & (255 << 1), bx, by);
+		Float lx1x = lerp(ax, bx, xs);
+		Float ly1x = lerp(ay, by, xs);
+
+		xr += lerp(lx0x, lx1x, ys) * warpAmp;
+		yr += lerp(ly0x, ly1x, ys) * warpAmp;
+	}
+
+	// FastNoiseLite::DomainWarp with a BasicGrid warp. WARP is the warp generator's
+	// fractal type, anything but the two domain warp fractals warps once
+	template <int WARP>
+	static NOISE_INLINE void warp(const NoiseWarpParams &params, Float &x, Float &y)
+	{
+		int seed = params.seed;
+		float amp = params.amp;
+		float freq = params.frequency;
+
+		if (WARP == FastNoiseLite::FractalType_DomainWarpProgressive)
+		{
+			for (int i = 0; i < params.octaves; i++)
+			{
+				Float xs = x;
+				Float ys = y;
+				warpBasicGrid(seed++, amp, freq, xs, ys, x, y);
+				amp *= params.gain;
+				freq *= params.lacunarity;
+			}
+		}
+		else if (WARP == FastNoiseLite::FractalType_DomainWarpIndependent)
+		{
+			Float xs = x;
+			Float ys = y;
+			for (int i = 0; i < params.octaves; i++)
+			{
+				warpBasicGrid(seed++, amp, freq, xs, ys, x, y);
+				amp *= params.gain;
+				freq *= params.lacunarity;
+			}
+		}
+		else
+		{
+			Float xs = x;
+			Float ys = y;
+			warpBasicGrid(seed, amp, freq, xs, ys, x, y);
+		}
+	}
+
+	// warp then noise, the warped points stay in registers
+	template <int NOISE, int FRACTAL, int WARP>
+	static NOISE_INLINE void warped(const NoiseKernelParams &params, const NoiseWarpParams &warpParams, const NoisePoints &points, float *out)
+	{
+		Int lanes;
+		for (int lane = 0; lane < N; lane++)
+			lanes[lane] = lane;
+
+		if (points.x)
+		{
+			for (int i = 0; i < points.count; i += N)
+			{
+				int count = i + N <= points.count ? N : points.count - i;
+				Float x = Float{}, y = Float{};
+				memcpy(&x, points.x + i, count * sizeof(float));
+				memcpy(&y, points.y + i, count * sizeof(float));
+
+				warp<WARP>(warpParams, x, y);
+				Float noise = fractal<NOISE, FRACTAL>(params, x * params.frequency, y * params.frequency);
+				memcpy(out + i, &noise, count * sizeof(float));
+			}
+			return;
+		}
+
+		for (int row = 0; row < points.height; row++)
+		{
+			float yPos = points.yStart + row * points.step;
+
+			for (int column = 0; column < points.width; column += N)
+			{
+				int count = column + N <= points.width ? N : points.width - column;
+				Float x = points.xStart + toFloat(lanes + column) * points.step;
+				Float y = Float{} + yPos;
+
+				warp<WARP>(warpParams, x, y);
+				Float noise = fractal<NOISE, FRACTAL>(params, x * params.frequency, y * params.frequency);
+				memcpy(out + column, &noise, count * sizeof(float));
+			}
+
+			out += points.width;
+		}
+	}
+
+	template <int WARP>
+	static NOISE_INLINE void warpPoints(const NoiseWarpParams &params, float *x, float *y, int count)
+	{
+		for (int i = 0; i < count; i += N)
+		{
+			int lanes = i + N <= count ? N : count - i;
+			Float xv = Float{}, yv = Float{};
+			memcpy(&xv, x + i, lanes * sizeof(float));
+			memcpy(&yv, y + i, lanes * sizeof(float));
+
+			warp<WARP>(params, xv, yv);
+			memcpy(x + i, &xv, lanes * sizeof(float));
+			memcpy(y + i, &yv, lanes * sizeof(float));
+		}
+	}
+};
+
+// one entry point per instruction set, instantiated for every noise and fractal type
+struct NoiseKernelsSse2
+{
+	template <int NOISE, int FRACTAL>
+	static void grid(const NoiseKernelParams &params, float xStart, float yStart, float step, int width, int height, float *out)
+	{
+		NoiseLanes<4>::grid<NOISE, FRACTAL>(params, xStart, yStart, step, width, height, out);
+	}
+
+	template <int NOISE, int FRACTAL>
+	static void layers(const NoiseKernelParams &params, const int *seeds, int layers, float xStart, float yStart, float step, int width, int height, float *const *out)
+	{
+		NoiseLanes<4>::gridLayers<NOISE, FRACTAL>(params, seeds, layers, xStart, yStart, step, width, height, out);
+	}
+
+	template <int NOISE, int FRACTAL, int WARP>
+	static void warped(const NoiseKernelParams &params, const NoiseWarpParams &warp, const NoisePoints &points, float *out)
+	{
+		NoiseLanes<4>::warped<NOISE, FRACTAL, WARP>(params, warp, points, out);
+	}
+
+	template <int WARP>
+	static void warp(const NoiseWarpParams &warp, float *x, float *y, int count)
+	{
+		NoiseLanes<4>::warpPoints<WARP>(warp, x, y, count);
+	}
+};
+
+struct NoiseKernelsAvx2
+{
+	template <int NOISE, int FRACTAL>
+	__attribute__((target("avx2"))) static void grid(const NoiseKernelParams &params, float xStart, float yStart, float step, int width, int height, float *out)
+	{
+		NoiseLanes<8>::grid<NOISE, FRACTAL>(params, xStart, yStart, step, width, height, out);
+	}
+
+	template <int NOISE, int FRACTAL>
+	__attribute__((target("avx2"))) static void layers(const NoiseKernelParams &params, const int *seeds, int layers, float xStart, float yStart, float step, int width, int height, float *const *out)
+	{
+		NoiseLanes<8>::gridLayers<NOISE, FRACTAL>(params, seeds, layers, xStart, yStart, step, width, height, out);
+	}
+
+	template <int NOISE, int FRACTAL, int WARP>
+	__attribute__((target("avx2"))) static void warped(const NoiseKernelParams &params, const NoiseWarpParams &warp, const NoisePoints &points, float *out)
+	{
+		NoiseLanes<8>::warped<NOISE, FRACTAL, WARP>(params, warp, points, out);
+	}
+
+	template <int WARP>
+	__attribute__((target("avx2"))) static void warp(const NoiseWarpParams &warp, float *x, float *y, int count)
+	{
+		NoiseLanes<8>::warpPoints<WARP>(warp, x, y, count);
+	}
+};
+
+// AVX-512F implies FMA, contraction is turned off to keep the results identical
+struct NoiseKernelsAvx512
+{
+	template <int NOISE, int FRACTAL>
+	__attribute__((target("avx512f"), optimize("fp-contract=off"))) static void grid(const NoiseKernelParams &params, float xStart, float yStart, float step, int width, int height, float *out)
+	{
+		NoiseLanes<16>::grid<NOISE, FRACTAL>(params, xStart, yStart, step, width, height, out);
+	}
+
+	template <int NOISE, int FRACTAL>
+	__attribute__((target("avx512f"), optimize("fp-contract=off"))) static void layers(const NoiseKernelParams &params, const int *seeds, int layers, float xStart, float yStart, float step, int width, int height, float *const *out)
+	{
+		NoiseLanes<16>::gridLayers<NOISE, FRACTAL>(params, seeds, layers, xStart, yStart, step, width, height, out);
+	}
+
+	template <int NOISE, int FRACTAL, int WARP>
+	__attribute__((target("avx512f"), optimize("fp-contract=off"))) static void warped(const NoiseKernelParams &params, const NoiseWarpParams &warp, const NoisePoints &points, float *out)
+	{
+		NoiseLanes<16>::warped<NOISE, FRACTAL, WARP>(params, warp, points, out);
+	}
+
+	template <int WARP>
+	__attribute__((target("avx512f"), optimize("fp-contract=off"))) static void warp(const NoiseWarpParams &warp, float *x, float *y, int count)
+	{
+		NoiseLanes<16>::warpPoints<WARP>(warp, x, y, count);
+	}
+};
+
+// NULL for noise types without a vectorized kernel
+template <typename Kernels>
+NoiseGridKernel selectNoiseKernel(int noiseType, int fractalType)
+{
+	static const NoiseGridKernel perlin[] = {
+		Kernels::template grid<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_None>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_FBm>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_Ridged>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_PingPong>};
+	static const NoiseGridKernel value[] = {
+		Kernels::template grid<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_None>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_FBm>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_Ridged>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_PingPong>};
+	static const NoiseGridKernel cellular[] = {
+		Kernels::template grid<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_None>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_FBm>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_Ridged>,
+		Kernels::template grid<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_PingPong>};
+
+	// GetNoise treats the domain warp fractal types like no fractal
+	if (fractalType > FastNoiseLite::FractalType_PingPong)
+		fractalType = FastNoiseLite::FractalType_None;
+
+	if (noiseType == FastNoiseLite::NoiseType_Perlin)
+		return perlin[fractalType];
+	if (noiseType == FastNoiseLite::NoiseType_Value)
+		return value[fractalType];
+	if (noiseType == FastNoiseLite::NoiseType_Cellular)
+		return cellular[fractalType];
+	return NULL;
+}
+
+// NULL for noise types without a vectorized kernel, see selectNoiseKernel
+template <typename Kernels>
+NoiseLayersKernel selectNoiseLayersKernel(int noiseType, int fractalType)
+{
+	static const NoiseLayersKernel perlin[] = {
+		Kernels::template layers<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_None>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_FBm>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_Ridged>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Perlin, FastNoiseLite::FractalType_PingPong>};
+	static const NoiseLayersKernel value[] = {
+		Kernels::template layers<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_None>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_FBm>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_Ridged>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Value, FastNoiseLite::FractalType_PingPong>};
+	static const NoiseLayersKernel cellular[] = {
+		Kernels::template layers<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_None>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_FBm>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_Ridged>,
+		Kernels::template layers<FastNoiseLite::NoiseType_Cellular, FastNoiseLite::FractalType_PingPong>};
+
+	if (fractalType > FastNoiseLite::FractalType_PingPong)
+		fractalType = FastNoiseLite::FractalType_None;
+
+	if (noiseType == FastNoiseLite::NoiseType_Perlin)
+		return perlin[fractalType];
+	if (noiseType == FastNoiseLite::NoiseType_Value)
+		return value[fractalType];
+	if (noiseType == FastNoiseLite::NoiseType_Cellular)
+		return cellular[fractalType];
+	return NULL;
+}
+
+// DomainWarp only tells the two domain warp fractal types apart from a single warp
+inline int noiseWarpIndex(int warpFractalType)
+{
+	if (warpFractalType == FastNoiseLite::FractalType_DomainWarpProgressive)
+		return 1;
+	if (warpFractalType == FastNoiseLite::FractalType_DomainWarpIndependent)
+		return 2;
+	return 0;
+}
+
+template <typename Kernels, int NOISE, int FRACTAL>
+NoiseWarpedKernel selectNoiseWarpedKernel(int warpFractalType)
+{
+	static const NoiseWarpedKernel kernels[] = {
+		Kernels::template warped<NOISE, FRACTAL, FastNoiseLite::FractalType_None>,
+		Kernels::template warped<NOISE, FRACTAL, FastNoiseLite::FractalType_DomainWarpProgressive>,
+		Kernels::template warped<NOISE, FRACTAL, FastNoiseLite::FractalType_DomainWarpIndependent>};
+	return kernels[noiseWarpIndex(warpFractalType)];
+}
+
+template <typename Kernels, int NOISE>
+NoiseWarpedKernel selectNoiseWarpedKernel(int fractalType, int warpFractalType)
+{
+	switch (fractalType)
+	{
+	case FastNoiseLite::FractalType_FBm:
+		return selectNoiseWarpedKernel<Kernels, NOISE, FastNoiseLite::FractalType_FBm>(warpFractalType);
+	case FastNoiseLite::FractalType_Ridged:
+		return selectNoiseWarpedKernel<Kernels, NOISE, FastNoiseLite::FractalType_Ridged>(warpFractalType);
+	case FastNoiseLite::FractalType_PingPong:
+		return selectNoiseWarpedKernel<Kernels, NOISE, FastNoiseLite::FractalType_PingPong>(warpFractalType);
+	default:
+		return selectNoiseWarpedKernel<Kernels, NOISE, FastNoiseLite::FractalType_None>(warpFractalType);
+	}
+}
+
+// NULL unless the noise is vectorized and the warp is BasicGrid
+template <typename Kernels>
+NoiseWarpedKernel selectNoiseWarpedKernel(const FastNoiseLite &noise, const FastNoiseLite &warp)
+{
+	if (warp.GetDomainWarpType() != FastNoiseLite::DomainWarpType_BasicGrid)
+		return NULL;
+
+	if (noise.GetNoiseType() == FastNoiseLite::NoiseType_Perlin)
+		return selectNoiseWarpedKernel<Kernels, FastNoiseLite::NoiseType_Perlin>(noise.GetFractalType(), warp.GetFractalType());
+	if (noise.GetNoiseType() == FastNoiseLite::NoiseType_Value)
+		return selectNoiseWarpedKernel<Kernels, FastNoiseLite::NoiseType_Value>(noise.GetFractalType(), warp.GetFractalType());
+	if (noise.GetNoiseType() == FastNoiseLite::NoiseType_Cellular)
+		return selectNoiseWarpedKernel<Kernels, FastNoiseLite::NoiseType_Cellular>(noise.GetFractalType(), warp.GetFractalType());
+	return NULL;
+}
+
+template <typename Kernels>
+NoiseWarpKernel selectNoiseWarpKernel(const FastNoiseLite &warp)
+{
+	static const NoiseWarpKernel kernels[] = {
+		Kernels::template warp<FastNoiseLite::FractalType_None>,
+		Kernels::template warp<FastNoiseLite::FractalType_DomainWarpProgressive>,
+		Kernels::template warp<FastNoiseLite::FractalType_DomainWarpIndependent>};
+
+	if (warp.GetDomainWarpType() != FastNoiseLite::DomainWarpType_BasicGrid)
+		return NULL;
+	return kernels[noiseWarpIndex(warp.GetFractalType())];
+}
+
+#endif
+
+// widest instruction set the CPU and OS support. __builtin_cpu_supports also checks
+// that the OS saves the AVX and AVX-512 registers
+inline NoiseIsa detectNoiseIsa()
+{
+#if NOISE_DISPATCH_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return NOISE_ISA_AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return NOISE_ISA_AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return NOISE_ISA_SSE2;
+#endif
+	return NOISE_ISA_SCALAR;
+}
+
+class NoiseDispatch
+{
+private:
+	NoiseIsa isa = NOISE_ISA_SCALAR;
+	NoiseIsa detected = NOISE_ISA_SCALAR;
+
+public:
+	// picks the widest supported instruction set. forced (a NOISE_ISA_NAMES entry, falling
+	// back to the GLTERRAIN_NOISE_ISA environment variable) narrows it down for testing
+	NoiseIsa init(std::string forced = "")
+	{
+		detected = isa = detectNoiseIsa();
+
+		if (forced.empty() && getenv("GLTERRAIN_NOISE_ISA"))
+			forced = getenv("GLTERRAIN_NOISE_ISA");
+		if (forced.empty())
+			return isa;
+
+		for (int i = 0; i < NOISE_ISA_COUNT; i++)
+		{
+			if (forced != NOISE_ISA_NAMES[i])
+				continue;
+
+			// running wider kernels than the CPU has would fault
+			if (i > detected)
+				std::cout << "noise: " << forced << " not supported, using " << NOISE_ISA_NAMES[detected] << std::endl;
+			else
+				isa = (NoiseIsa)i;
+			return isa;
+		}
+
+		std::cout << "noise: unknown instruction set " << forced << ", using " << NOISE_ISA_NAMES[isa] << std::endl;
+		return isa;
+	}
+
+	NoiseIsa getIsa() const
+	{
+		return isa;
+	}
+
+	NoiseGridKernel kernel(int noiseType, int fractalType) const
+	{
+#if NOISE_DISPATCH_X86
+		switch (isa)
+		{
+		case NOISE_ISA_SSE2:
+			return selectNoiseKernel<NoiseKernelsSse2>(noiseType, fractalType);
+		case NOISE_ISA_AVX2:
+			return selectNoiseKernel<NoiseKernelsAvx2>(noiseType, fractalType);
+		case NOISE_ISA_AVX512:
+			return selectNoiseKernel<NoiseKernelsAvx512>(noiseType, fractalType);
+		default:
+			break;
+		}
+#endif
+		return NULL;
+	}
+
+	NoiseGridKernel kernel(const FastNoiseLite &noise) const
+	{
+		return kernel(noise.GetNoiseType(), noise.GetFractalType());
+	}
+
+	NoiseLayersKernel layersKernel(const FastNoiseLite &noise) const
+	{
+#if NOISE_DISPATCH_X86
+		switch (isa)
+		{
+		case NOISE_ISA_SSE2:
+			return selectNoiseLayersKernel<NoiseKernelsSse2>(noise.GetNoiseType(), noise.GetFractalType());
+		case NOISE_ISA_AVX2:
+			return selectNoiseLayersKernel<NoiseKernelsAvx2>(noise.GetNoiseType(), noise.GetFractalType());
+		case NOISE_ISA_AVX512:
+			return selectNoiseLayersKernel<NoiseKernelsAvx512>(noise.GetNoiseType(), noise.GetFractalType());
+		default:
+			break;
+		}
+#endif
+		return NULL;
+	}
+
+	NoiseWarpedKernel warpedKernel(const FastNoiseLite &noise, const FastNoiseLite &warp) const
+	{
+#if NOISE_DISPATCH_X86
+		switch (isa)
+		{
+		case NOISE_ISA_SSE2:
+			return selectNoiseWarpedKernel<NoiseKernelsSse2>(noise, warp);
+		case NOISE_ISA_AVX2:
+			return selectNoiseWarpedKernel<NoiseKernelsAvx2>(noise, warp);
+		case NOISE_ISA_AVX512:
+			return selectNoiseWarpedKernel<NoiseKernelsAvx512>(noise, warp);
+		default:
+			break;
+		}
+#endif
+		return NULL;
+	}
+
+	NoiseWarpKernel warpKernel(const FastNoiseLite &warp) const
+	{
+#if NOISE_DISPATCH_X86
+		switch (isa)
+		{
+		case NOISE_ISA_SSE2:
+			return selectNoiseWarpKernel<NoiseKernelsSse2>(warp);
+		case NOISE_ISA_AVX2:
+			return selectNoiseWarpKernel<NoiseKernelsAvx2>(warp);
+		case NOISE_ISA_AVX512:
+			return selectNoiseWarpKernel<NoiseKernelsAvx512>(warp);
+		default:
+			break;
+		}
+#endif
+		return NULL;
+	}
+
+	// the log line, which path the current settings of noise take
+	void describe(const FastNoiseLite &noise) const
+	{
+		std::cout << "noise: " << NOISE_TYPE_NAMES[noise.GetNoiseType()] << " " << FRACTAL_TYPE_NAMES[noise.GetFractalType()] << " on ";
+		if (kernel(noise))
+			std::cout << NOISE_ISA_NAMES[isa] << " kernels";
+		else
+			std::cout << "the scalar path";
+		std::cout << " (cpu supports " << NOISE_ISA_NAMES[detected] << ")" << std::endl;
+	}
+
+	// FastNoiseLite::GetNoiseGrid through the selected kernels
+	void getNoiseGrid(const FastNoiseLite &noise, float xStart, float yStart, float step, int width, int height, float *out) const
+	{
+		NoiseGridKernel gridKernel = kernel(noise);
+		if (!gridKernel)
+		{
+			noise.GetNoiseGrid(xStart, yStart, step, width, height, out);
+			return;
+		}
+
+		gridKernel(kernelParams(noise, (float)noise.GetFractalOctaves()), xStart, yStart, step, width, height, out);
+	}
+
+	// getNoiseGrid of noise with each of the seeds, out[layer] gets the grid of seeds[layer].
+	// every layer of a sample shares the lattice cell, offsets and interpolation weights,
+	// only the hashes differ
+	void getNoiseGridLayers(const FastNoiseLite &noise, const int *seeds, int layers, float xStart, float yStart, float step, int width, int height,
+							float *const *out) const
+	{
+		NoiseLayersKernel layersKernel = this->layersKernel(noise);
+		if (!layersKernel)
+		{
+			FastNoiseLite seeded = noise;
+			for (int layer = 0; layer < layers; layer++)
+			{
+				seeded.SetSeed(seeds[layer]);
+				seeded.GetNoiseGrid(xStart, yStart, step, width, height, out[layer]);
+			}
+			return;
+		}
+
+		NoiseKernelParams params = kernelParams(noise, (float)noise.GetFractalOctaves());
+		for (int first = 0; first < layers; first += NOISE_MAX_LAYERS)
+			layersKernel(params, seeds + first, std::min(layers - first, NOISE_MAX_LAYERS), xStart, yStart, step, width, height, out + first);
+	}
+
+	// the grid with FastNoiseLite::GetNoiseLod, one footprint for the whole grid. pass the
+	// largest footprint the grid can be seen at, its own step is the finest worth sampling
+	void getNoiseGridLod(const FastNoiseLite &noise, float xStart, float yStart, float step, int width, int height, float footprint, float *out) const
+	{
+		NoiseGridKernel gridKernel = kernel(noise);
+		if (!gridKernel)
+		{
+			for (int y = 0; y < height; y++)
+			{
+				float yPos = yStart + y * step;
+				for (int x = 0; x < width; x++)
+					*out++ = noise.GetNoiseLod(xStart + x * step, yPos, footprint);
+			}
+			return;
+		}
+
+		gridKernel(kernelParams(noise, noise.GetFractalOctavesForFootprint(footprint)), xStart, yStart, step, width, height, out);
+	}
+
+	// getNoiseGridLod of a chunk at an integer world origin, xStart and yStart are relative
+	// to it. the origin is split into whole lattice cells and a fraction per octave once, in
+	// double, so the float kernels hash exact cells and only interpolate small offsets. far
+	// out the result stays as fine as near the world origin, at origin 0 it matches
+	// getNoiseGridLod bit for bit. a footprint of 0 keeps every octave
+	void getNoiseGridChunk(const FastNoiseLite &noise, int originX, int originY, float xStart, float yStart, float step, int width, int height,
+						   float footprint, float *out) const
+	{
+		NoiseGridKernel gridKernel = kernel(noise);
+		if (!gridKernel || noise.GetFractalOctaves() > NOISE_CHUNK_OCTAVES)
+		{
+			// loses precision away from the origin like GetNoise does
+			getNoiseGridLod(noise, originX + xStart, originY + yStart, step, width, height, footprint, out);
+			return;
+		}
+
+		NoiseKernelParams params = kernelParams(noise, noise.GetFractalOctavesForFootprint(footprint));
+		NoiseChunkOrigin origin = chunkOrigin(noise, originX, originY);
+		params.origin = &origin;
+		gridKernel(params, xStart, yStart, step, width, height, out);
+	}
+
+	// FastNoiseLite::GetNoiseOctave over a grid, identical to it while the lacunarity is a
+	// power of two (the kernel scales the frequency instead of the coordinates)
+	void getNoiseOctaveGrid(const FastNoiseLite &noise, int octave, float xStart, float yStart, float step, int width, int height, float *out) const
+	{
+		NoiseGridKernel gridKernel = kernel(noise.GetNoiseType(), FastNoiseLite::FractalType_None);
+		if (!gridKernel)
+		{
+			for (int y = 0; y < height; y++)
+			{
+				float yPos = yStart + y * step;
+				for (int x = 0; x < width; x++)
+					*out++ = noise.GetNoiseOctave(xStart + x * step, yPos, octave);
+			}
+			return;
+		}
+
+		NoiseKernelParams params = kernelParams(noise, 1.0f);
+		params.seed += octave;
+		for (int i = 0; i < octave; i++)
+			params.frequency *= params.lacunarity;
+		gridKernel(params, xStart, yStart, step, width, height, out);
+	}
+
+	// FastNoiseLite::DomainWarpBatch, BasicGrid warps are vectorized
+	void warpBatch(const FastNoiseLite &warp, float *x, float *y, int count) const
+	{
+		NoiseWarpKernel pointKernel = warpKernel(warp);
+		if (!pointKernel)
+		{
+			warp.DomainWarpBatch(x, y, count);
+			return;
+		}
+
+		pointKernel(warpParams(warp), x, y, count);
+	}
+
+	// FastNoiseLite::GetNoiseWarpedBatch, vectorized when the noise is and the warp is BasicGrid
+	void getNoiseWarpedBatch(const FastNoiseLite &noise, const FastNoiseLite &warp, const float *x, const float *y, float *out, int count) const
+	{
+		NoiseWarpedKernel pointKernel = warpedKernel(noise, warp);
+		if (!pointKernel)
+		{
+			noise.GetNoiseWarpedBatch(warp, x, y, out, count);
+			return;
+		}
+
+		NoisePoints points = {};
+		points.x = x;
+		points.y = y;
+		points.count = count;
+		pointKernel(kernelParams(noise, (float)noise.GetFractalOctaves()), warpParams(warp), points, out);
+	}
+
+	// FastNoiseLite::GetNoiseWarpedGrid, see getNoiseWarpedBatch
+	void getNoiseWarpedGrid(const FastNoiseLite &noise, const FastNoiseLite &warp, float xStart, float yStart, float step, int width, int height, float *out) const
+	{
+		NoiseWarpedKernel pointKernel = warpedKernel(noise, warp);
+		if (!pointKernel)
+		{
+			noise.GetNoiseWarpedGrid(warp, xStart, yStart, step, width, height, out);
+			return;
+		}
+
+		NoisePoints points = {};
+		points.xStart = xStart;
+		points.yStart = yStart;
+		points.step = step;
+		points.width = width;
+		points.height = height;
+		pointKernel(kernelParams(noise, (float)noise.GetFractalOctaves()), warpParams(warp), points, out);
+	}
+
+	static NoiseWarpParams warpParams(const FastNoiseLite &warp)
+	{
+		NoiseWarpParams params;
+		params.seed = warp.GetSeed();
+		params.frequency = warp.GetFrequency();
+		params.octaves = warp.GetFractalOctaves();
+		params.lacunarity = warp.GetFractalLacunarity();
+		params.gain = warp.GetFractalGain();
+		params.amp = warp.GetDomainWarpAmp() * warp.GetFractalBounding();
+		return params;
+	}
+
+	// the origin times each octave's frequency, split into whole cells and the rest
+	static NoiseChunkOrigin chunkOrigin(const FastNoiseLite &noise, int originX, int originY)
+	{
+		NoiseChunkOrigin origin = {};
+		double frequency = noise.GetFrequency();
+		int octaves = std::min(noise.GetFractalOctaves(), NOISE_CHUNK_OCTAVES);
+
+		for (int i = 0; i < octaves; i++)
+		{
+			double x = originX * frequency;
+			double y = originY * frequency;
+			double xCell = std::floor(x);
+			double yCell = std::floor(y);
+
+			// the hashes only see the cells modulo 2^32, like the scalar int overflow
+			origin.xCell[i] = (int)(unsigned int)(long long)xCell;
+			origin.yCell[i] = (int)(unsigned int)(long long)yCell;
+			origin.x[i] = (float)(x - xCell);
+			origin.y[i] = (float)(y - yCell);
+
+			frequency *= noise.GetFractalLacunarity();
+		}
+		return origin;
+	}
+
+	static NoiseKernelParams kernelParams(const FastNoiseLite &noise, float lodOctaves)
+	{
+		NoiseKernelParams params;
+		params.seed = noise.GetSeed();
+		params.frequency = noise.GetFrequency();
+		params.octaves = noise.GetFractalOctaves();
+		params.lacunarity = noise.GetFractalLacunarity();
+		params.gain = noise.GetFractalGain();
+		params.weightedStrength = noise.GetFractalWeightedStrength();
+		params.bounding = noise.GetFractalBounding();
+		params.pingPongStrength = noise.GetFractalPingPongStrength();
+		params.lodOctaves = lodOctaves;
+		params.cellularDistanceFunction = noise.GetCellularDistanceFunction();
+		params.cellularReturnType = noise.GetCellularReturnType();
+		params.cellularJitter = noise.GetCellularJitter();
+		params.origin = NULL;
+		return params;
+	}
+};
+
+#endif
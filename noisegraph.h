@@ -0,0 +1,534 @@
+#ifndef NOISEGRAPH_H
+#define NOISEGRAPH_H
+
+// terrain as a graph of noise sources and operators, loaded from a text file so it can
+// change without a rebuild. load() compiles the graph into a plan: identical nodes are
+// merged, nodes the output doesn't read are dropped and every remaining node writes a
+// block buffer that's reused once its last reader has run. getNoiseGrid() runs the
+// whole plan on one NOISE_GRAPH_BLOCK sized tile at a time, so the intermediates stay
+// in L1 instead of going through full grids. see terrain.noise for the file format
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fastnoise.h"
+#include "noiseconfig.h"
+#include "noisedispatch.h"
+
+const int NOISE_GRAPH_BLOCK = 16; // samples per tile side, 1 KB per buffer
+const int NOISE_GRAPH_MAX_NODES = 64;
+
+// the warp of noise nodes with a warp amp, the same as main.cpp's --warp
+const float NOISE_GRAPH_WARP_FREQUENCY = 0.005f;
+const int NOISE_GRAPH_WARP_OCTAVES = 3;
+
+enum NoiseGraphOp
+{
+	NOISE_GRAPH_NOISE, // FastNoiseLite::GetNoise, domain warped first with a warp amp
+	NOISE_GRAPH_CONSTANT,
+	NOISE_GRAPH_ADD,
+	NOISE_GRAPH_SUB,
+	NOISE_GRAPH_MUL,
+	NOISE_GRAPH_MIN,
+	NOISE_GRAPH_MAX,
+	NOISE_GRAPH_SCALE, // a * factor + offset
+	NOISE_GRAPH_SELECT, // a where the control is below the threshold, b above, blended over falloff
+	NOISE_GRAPH_CURVE, // piecewise linear through x y points, flat past the ends
+	NOISE_GRAPH_OP_COUNT
+};
+
+const char *const NOISE_GRAPH_OP_NAMES[NOISE_GRAPH_OP_COUNT] = {"noise", "constant", "add", "sub", "mul", "min", "max", "scale", "select", "curve"};
+const int NOISE_GRAPH_OP_INPUTS[NOISE_GRAPH_OP_COUNT] = {0, 0, 2, 2, 2, 2, 2, 1, 3, 1};
+
+const char *const CELLULAR_DISTANCE_NAMES[] = {"euclidean", "euclideansq", "manhattan", "hybrid"};
+const char *const CELLULAR_RETURN_NAMES[] = {"cellvalue", "distance", "distance2", "distance2add", "distance2sub", "distance2mul", "distance2div"};
+
+// noise settings that take a number rather than a name
+const int NOISE_GRAPH_NUMBER_SETTING_COUNT = 12;
+const char *const NOISE_GRAPH_NUMBER_SETTINGS[NOISE_GRAPH_NUMBER_SETTING_COUNT] = {
+	"seed", "frequency", "octaves", "lacunarity", "gain", "weighted", "pingpong", "jitter", "warp", "warp-frequency", "warp-octaves", "warp-seed"};
+
+struct NoiseGraphNode
+{
+	std::string name;
+	NoiseGraphOp op = NOISE_GRAPH_CONSTANT;
+	int inputs[3] = {-1, -1, -1}; // earlier nodes
+	std::vector<float> values; // constant, scale factor and offset, select threshold and falloff, curve points
+	NoiseConfig noise;
+	NoiseConfig warp;
+	bool warped = false;
+};
+
+// a node in plan order, reading and writing block buffers
+struct NoiseGraphStep
+{
+	int node;
+	int out;
+	int inputs[3];
+};
+
+class NoiseGraph
+{
+private:
+	std::vector<NoiseGraphNode> nodes;
+	std::vector<NoiseGraphStep> plan;
+	int bufferCount = 0;
+
+	std::vector<float> blocks; // bufferCount buffers of NOISE_GRAPH_BLOCK * NOISE_GRAPH_BLOCK
+
+	static int findName(const char *const *names, int count, const std::string &name)
+	{
+		for (int i = 0; i < count; i++)
+			if (name == names[i])
+				return i;
+		return -1;
+	}
+
+	// the whole text has to be a number, atof and atoi would read "0.o1" as 0
+	static bool parseFloat(const std::string &text, float &value)
+	{
+		char *end = NULL;
+		value = strtof(text.c_str(), &end);
+		return !text.empty() && *end == '\0';
+	}
+
+	static bool parseInt(const std::string &text, int &value)
+	{
+		char *end = NULL;
+		long parsed = strtol(text.c_str(), &end, 10);
+		value = (int)parsed;
+		return !text.empty() && *end == '\0' && parsed == value;
+	}
+
+	// noise key value pairs, see terrain.noise. error is left empty when they parse
+	static void parseNoise(std::istringstream &fields, NoiseGraphNode &node, std::string &error)
+	{
+		NoiseConfigBuilder noise;
+		NoiseConfigBuilder warp = NoiseConfigBuilder()
+									  .frequency(NOISE_GRAPH_WARP_FREQUENCY)
+									  .domainWarpType(FastNoiseLite::DomainWarpType_BasicGrid)
+									  .fractalType(FastNoiseLite::FractalType_DomainWarpProgressive)
+									  .fractalOctaves(NOISE_GRAPH_WARP_OCTAVES);
+
+		std::string key, value;
+		while (fields >> key)
+		{
+			if (!(fields >> value))
+			{
+				error = "MISSING_VALUE " + key;
+				return;
+			}
+
+			int index = 0;
+			int integer = 0;
+			float number = 0.0f;
+			bool isInt = parseInt(value, integer);
+			bool isFloat = parseFloat(value, number);
+
+			if (key == "seed" && isInt)
+				noise.seed(integer);
+			else if (key == "frequency" && isFloat)
+				noise.frequency(number);
+			else if (key == "type" && (index = findName(NOISE_TYPE_NAMES, 6, value)) >= 0)
+				noise.noiseType((FastNoiseLite::NoiseType)index);
+			else if (key == "fractal" && (index = findName(FRACTAL_TYPE_NAMES, 4, value)) >= 0)
+				noise.fractalType((FastNoiseLite::FractalType)index);
+			else if (key == "octaves" && isInt)
+				noise.fractalOctaves(integer);
+			else if (key == "lacunarity" && isFloat)
+				noise.fractalLacunarity(number);
+			else if (key == "gain" && isFloat)
+				noise.fractalGain(number);
+			else if (key == "weighted" && isFloat)
+				noise.fractalWeightedStrength(number);
+			else if (key == "pingpong" && isFloat)
+				noise.fractalPingPongStrength(number);
+			else if (key == "distance" && (index = findName(CELLULAR_DISTANCE_NAMES, 4, value)) >= 0)
+				noise.cellularDistanceFunction((FastNoiseLite::CellularDistanceFunction)index);
+			else if (key == "return" && (index = findName(CELLULAR_RETURN_NAMES, 7, value)) >= 0)
+				noise.cellularReturnType((FastNoiseLite::CellularReturnType)index);
+			else if (key == "jitter" && isFloat)
+				noise.cellularJitter(number);
+			else if (key == "warp" && isFloat)
+			{
+				warp.domainWarpAmp(number);
+				node.warped = true;
+			}
+			else if (key == "warp-frequency" && isFloat)
+				warp.frequency(number);
+			else if (key == "warp-octaves" && isInt)
+				warp.fractalOctaves(integer);
+			else if (key == "warp-seed" && isInt)
+				warp.seed(integer);
+			else if (findName(NOISE_GRAPH_NUMBER_SETTINGS, NOISE_GRAPH_NUMBER_SETTING_COUNT, key) >= 0)
+			{
+				error = "BAD_NUMBER " + key;
+				return;
+			}
+			else
+			{
+				error = "UNKNOWN_SETTING " + key + " " + value;
+				return;
+			}
+		}
+
+		node.noise = noise.build();
+		node.warp = warp.build();
+	}
+
+	// everything a node's output depends on, identical nodes have the same key
+	static std::string key(const NoiseGraphNode &node)
+	{
+		std::ostringstream key;
+		key << std::hexfloat << node.op << " " << node.inputs[0] << " " << node.inputs[1] << " " << node.inputs[2];
+		for (float value : node.values)
+			key << " " << value;
+
+		if (node.op == NOISE_GRAPH_NOISE)
+		{
+			const FastNoiseLite &noise = node.noise.get();
+			key << " " << noise.GetSeed() << " " << noise.GetFrequency() << " " << noise.GetNoiseType() << " " << noise.GetFractalType() << " "
+				<< noise.GetFractalOctaves() << " " << noise.GetFractalLacunarity() << " " << noise.GetFractalGain() << " "
+				<< noise.GetFractalWeightedStrength() << " " << noise.GetFractalPingPongStrength() << " " << noise.GetCellularDistanceFunction() << " "
+				<< noise.GetCellularReturnType() << " " << noise.GetCellularJitter();
+			if (node.warped)
+			{
+				const FastNoiseLite &warp = node.warp.get();
+				key << " warp " << warp.GetSeed() << " " << warp.GetFrequency() << " " << warp.GetFractalOctaves() << " " << warp.GetDomainWarpAmp();
+			}
+		}
+		return key.str();
+	}
+
+	// merges identical nodes, drops unread ones and gives each step a buffer
+	void compile()
+	{
+		int count = nodes.size();
+
+		// inputs are always earlier nodes, so they're already merged when a node is keyed
+		std::vector<int> merged(count);
+		std::map<std::string, int> keys;
+		for (int i = 0; i < count; i++)
+		{
+			for (int &input : nodes[i].inputs)
+				if (input >= 0)
+					input = merged[input];
+
+			auto found = keys.emplace(key(nodes[i]), i);
+			merged[i] = found.first->second;
+		}
+
+		// the last node is the output
+		std::vector<bool> used(count, false);
+		used[merged[count - 1]] = true;
+		for (int i = count - 1; i >= 0; i--)
+		{
+			if (!used[i])
+				continue;
+			for (int input : nodes[i].inputs)
+				if (input >= 0)
+					used[input] = true;
+		}
+
+		std::vector<int> lastRead(count, -1);
+		std::vector<int> order;
+		for (int i = 0; i < count; i++)
+		{
+			if (!used[i])
+				continue;
+			for (int input : nodes[i].inputs)
+				if (input >= 0)
+					lastRead[input] = order.size();
+			order.push_back(i);
+		}
+
+		// every op reads and writes the same sample, so a step can write over an input it
+		// was the last to read
+		std::vector<int> buffers(count, -1);
+		std::vector<int> freeBuffers;
+		plan.clear();
+		bufferCount = 0;
+		for (int i : order)
+		{
+			NoiseGraphStep step;
+			step.node = i;
+			for (int j = 0; j < 3; j++)
+			{
+				int input = nodes[i].inputs[j];
+				step.inputs[j] = input >= 0 ? buffers[input] : -1;
+			}
+			for (int input : nodes[i].inputs)
+			{
+				if (input >= 0 && lastRead[input] == (int)plan.size())
+				{
+					freeBuffers.push_back(buffers[input]);
+					lastRead[input] = -1;
+				}
+			}
+
+			if (freeBuffers.empty())
+				step.out = bufferCount++;
+			else
+			{
+				step.out = freeBuffers.back();
+				freeBuffers.pop_back();
+			}
+			buffers[i] = step.out;
+			plan.push_back(step);
+		}
+	}
+
+	static float select(float a, float b, float control, float threshold, float falloff)
+	{
+		if (control <= threshold - falloff)
+			return a;
+		if (control >= threshold + falloff)
+			return b;
+
+		float t = (control - (threshold - falloff)) / (2.0f * falloff);
+		t = t * t * (3.0f - 2.0f * t);
+		return a + (b - a) * t;
+	}
+
+	static float curve(const std::vector<float> &points, float x)
+	{
+		int last = points.size() - 2;
+		if (x <= points[0])
+			return points[1];
+		if (x >= points[last])
+			return points[last + 1];
+
+		int i = 2;
+		while (x > points[i])
+			i += 2;
+		float t = (x - points[i - 2]) / (points[i] - points[i - 2]);
+		return points[i - 1] + (points[i + 1] - points[i - 1]) * t;
+	}
+
+	// every op but noise, over count samples
+	static void apply(const NoiseGraphNode &node, const float *a, const float *b, const float *c, float *out, int count)
+	{
+		switch (node.op)
+		{
+		case NOISE_GRAPH_CONSTANT:
+			std::fill(out, out + count, node.values[0]);
+			break;
+		case NOISE_GRAPH_ADD:
+			for (int i = 0; i < count; i++)
+				out[i] = a[i] + b[i];
+			break;
+		case NOISE_GRAPH_SUB:
+			for (int i = 0; i < count; i++)
+				out[i] = a[i] - b[i];
+			break;
+		case NOISE_GRAPH_MUL:
+			for (int i = 0; i < count; i++)
+				out[i] = a[i] * b[i];
+			break;
+		case NOISE_GRAPH_MIN:
+			for (int i = 0; i < count; i++)
+				out[i] = std::min(a[i], b[i]);
+			break;
+		case NOISE_GRAPH_MAX:
+			for (int i = 0; i < count; i++)
+				out[i] = std::max(a[i], b[i]);
+			break;
+		case NOISE_GRAPH_SCALE:
+			for (int i = 0; i < count; i++)
+				out[i] = a[i] * node.values[0] + node.values[1];
+			break;
+		case NOISE_GRAPH_SELECT:
+			for (int i = 0; i < count; i++)
+				out[i] = select(a[i], b[i], c[i], node.values[0], node.values[1]);
+			break;
+		case NOISE_GRAPH_CURVE:
+			for (int i = 0; i < count; i++)
+				out[i] = curve(node.values, a[i]);
+			break;
+		default:
+			break;
+		}
+	}
+
+	float *buffer(int index)
+	{
+		return index >= 0 ? &blocks[index * NOISE_GRAPH_BLOCK * NOISE_GRAPH_BLOCK] : NULL;
+	}
+
+public:
+	// one node per line: name op arguments, # starts a comment. inputs are names of
+	// earlier nodes, so there can't be cycles, and the last node is the output
+	bool load(const std::string &filePath)
+	{
+		std::ifstream file(filePath);
+		if (!file)
+		{
+			std::cout << "ERROR::NOISE_GRAPH::FILE_NOT_SUCCESFULLY_READ: " << filePath << std::endl;
+			return false;
+		}
+
+		nodes.clear();
+		plan.clear();
+
+		std::map<std::string, int> names;
+		std::string line;
+		int lineNumber = 0;
+		while (std::getline(file, line))
+		{
+			lineNumber++;
+
+			// a comment runs to the end of the line, wherever it starts
+			std::istringstream fields(line.substr(0, line.find('#')));
+			NoiseGraphNode node;
+			std::string op;
+			if (!(fields >> node.name))
+				continue;
+
+			std::string error;
+			int opIndex = -1;
+			if (!(fields >> op) || (opIndex = findName(NOISE_GRAPH_OP_NAMES, NOISE_GRAPH_OP_COUNT, op)) < 0)
+				error = "UNKNOWN_OP " + op;
+			else if (names.count(node.name))
+				error = "DUPLICATE_NAME " + node.name;
+			else if ((int)nodes.size() == NOISE_GRAPH_MAX_NODES)
+				error = "TOO_MANY_NODES";
+			node.op = (NoiseGraphOp)opIndex;
+
+			for (int i = 0; error.empty() && i < NOISE_GRAPH_OP_INPUTS[opIndex]; i++)
+			{
+				std::string input;
+				fields >> input;
+				auto found = names.find(input);
+				if (found == names.end())
+					error = "UNKNOWN_INPUT " + input;
+				else
+					node.inputs[i] = found->second;
+			}
+
+			if (error.empty() && node.op == NOISE_GRAPH_NOISE)
+				parseNoise(fields, node, error);
+			else if (error.empty())
+			{
+				float value;
+				while (fields >> value)
+					node.values.push_back(value);
+				if (!fields.eof())
+					error = "BAD_NUMBER";
+			}
+
+			// optional arguments and argument counts
+			if (error.empty() && node.op == NOISE_GRAPH_SCALE && node.values.size() == 1)
+				node.values.push_back(0.0f);
+			if (error.empty() && node.op == NOISE_GRAPH_SELECT && node.values.size() == 1)
+				node.values.push_back(0.0f);
+			if (error.empty())
+			{
+				size_t values = node.values.size();
+				bool counted = node.op == NOISE_GRAPH_NOISE || (node.op == NOISE_GRAPH_CONSTANT && values == 1) ||
+							   (node.op == NOISE_GRAPH_SCALE && values == 2) || (node.op == NOISE_GRAPH_SELECT && values == 2) ||
+							   (node.op == NOISE_GRAPH_CURVE && values >= 4 && values % 2 == 0) || (NOISE_GRAPH_OP_INPUTS[node.op] == 2 && values == 0);
+				for (size_t i = 2; node.op == NOISE_GRAPH_CURVE && i < values; i += 2)
+					counted = counted && node.values[i] > node.values[i - 2];
+				if (!counted)
+					error = "BAD_ARGUMENTS " + op;
+			}
+
+			if (!error.empty())
+			{
+				std::cout << "ERROR::NOISE_GRAPH::" << error << ": " << filePath << ":" << lineNumber << std::endl;
+				nodes.clear();
+				return false;
+			}
+
+			names[node.name] = nodes.size();
+			nodes.push_back(node);
+		}
+
+		if (nodes.empty())
+		{
+			std::cout << "ERROR::NOISE_GRAPH::NO_NODES: " << filePath << std::endl;
+			return false;
+		}
+
+		compile();
+		blocks.assign(bufferCount * NOISE_GRAPH_BLOCK * NOISE_GRAPH_BLOCK, 0.0f);
+		std::cout << "noise graph: " << filePath << ", " << nodes.size() << " nodes, " << plan.size() << " steps, " << bufferCount
+				  << " block buffers" << std::endl;
+		return true;
+	}
+
+	bool empty() const
+	{
+		return plan.empty();
+	}
+
+	// the graph at one point, same as getNoiseGrid
+	float getNoise(float x, float y) const
+	{
+		float values[NOISE_GRAPH_MAX_NODES];
+		for (const NoiseGraphStep &step : plan)
+		{
+			const NoiseGraphNode &node = nodes[step.node];
+			if (node.op == NOISE_GRAPH_NOISE)
+			{
+				float warpedX = x, warpedY = y;
+				if (node.warped)
+					node.warp.get().DomainWarp(warpedX, warpedY);
+				values[step.out] = node.noise.getNoise(warpedX, warpedY);
+			}
+			else
+			{
+				const float *inputs[3];
+				for (int i = 0; i < 3; i++)
+					inputs[i] = step.inputs[i] >= 0 ? &values[step.inputs[i]] : NULL;
+				apply(node, inputs[0], inputs[1], inputs[2], &values[step.out], 1);
+			}
+		}
+		return values[plan.back().out];
+	}
+
+	// the graph over a grid with the layout of FastNoiseLite::GetNoiseGrid. each tile
+	// starts at xStart + x * step, which only rounds like the whole grid for exact steps.
+	// dispatch, if given, evaluates the noise with the vectorized kernels
+	void getNoiseGrid(const NoiseDispatch *dispatch, float xStart, float yStart, float step, int width, int height, float *out)
+	{
+		for (int yBlock = 0; yBlock < height; yBlock += NOISE_GRAPH_BLOCK)
+		{
+			for (int xBlock = 0; xBlock < width; xBlock += NOISE_GRAPH_BLOCK)
+			{
+				int blockWidth = std::min(NOISE_GRAPH_BLOCK, width - xBlock);
+				int blockHeight = std::min(NOISE_GRAPH_BLOCK, height - yBlock);
+				float x = xStart + xBlock * step;
+				float y = yStart + yBlock * step;
+
+				for (const NoiseGraphStep &planStep : plan)
+				{
+					const NoiseGraphNode &node = nodes[planStep.node];
+					float *blockOut = buffer(planStep.out);
+					if (node.op != NOISE_GRAPH_NOISE)
+						apply(node, buffer(planStep.inputs[0]), buffer(planStep.inputs[1]), buffer(planStep.inputs[2]), blockOut, blockWidth * blockHeight);
+					else if (node.warped && dispatch)
+						dispatch->getNoiseWarpedGrid(node.noise.get(), node.warp.get(), x, y, step, blockWidth, blockHeight, blockOut);
+					else if (node.warped)
+						node.noise.get().GetNoiseWarpedGrid(node.warp.get(), x, y, step, blockWidth, blockHeight, blockOut);
+					else if (dispatch)
+						dispatch->getNoiseGrid(node.noise.get(), x, y, step, blockWidth, blockHeight, blockOut);
+					else
+						node.noise.getNoiseGrid(x, y, step, blockWidth, blockHeight, blockOut);
+				}
+
+				const float *result = buffer(plan.back().out);
+				for (int row = 0; row < blockHeight; row++)
+					std::copy(result + row * blockWidth, result + (row + 1) * blockWidth, out + (yBlock + row) * width + xBlock);
+			}
+		}
+	}
+};
+
+#endif
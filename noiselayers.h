@@ -0,0 +1,117 @@
+#ifndef NOISELAYERS_H
+#define NOISELAYERS_H
+
+// the raw noise of every fractal octave over one grid, kept so gain, weighted strength,
+// ping pong strength, fractal type and octave count can change without evaluating the
+// lattice again. the stored octaves are recombined and only octaves the grid doesn't
+// have yet are computed
+
+#include <algorithm>
+#include <vector>
+
+#include "fastnoise.h"
+#include "memstats.h"
+#include "noisedispatch.h"
+
+typedef TrackedVector<float, MEMORY_CHUNK_CACHE> NoiseLayer;
+
+class NoiseLayers
+{
+private:
+	// everything the raw octaves of a 2D grid depend on
+	int seed = 0;
+	float frequency = 0.0f;
+	float lacunarity = 0.0f;
+	int noiseType = -1;
+	int cellularDistanceFunction = -1;
+	int cellularReturnType = -1;
+	float cellularJitter = 0.0f;
+	float xStart = 0.0f;
+	float yStart = 0.0f;
+	float step = 0.0f;
+	int width = 0;
+	int height = 0;
+
+	std::vector<NoiseLayer> layers;
+	std::vector<float> amps;
+
+	bool matches(const FastNoiseLite &noise, float xStart, float yStart, float step, int width, int height) const
+	{
+		return seed == noise.GetSeed() && frequency == noise.GetFrequency() && lacunarity == noise.GetFractalLacunarity() &&
+			   noiseType == noise.GetNoiseType() && cellularDistanceFunction == noise.GetCellularDistanceFunction() &&
+			   cellularReturnType == noise.GetCellularReturnType() && cellularJitter == noise.GetCellularJitter() &&
+			   this->xStart == xStart && this->yStart == yStart && this->step == step && this->width == width && this->height == height;
+	}
+
+public:
+	// FastNoiseLite::GetNoiseGrid from the stored octaves, returns how many octaves had to
+	// be computed. dispatch, if given, computes them with the vectorized kernels
+	int getNoiseGrid(const FastNoiseLite &noise, const NoiseDispatch *dispatch, float xStart, float yStart, float step, int width, int height, float *out)
+	{
+		if (!matches(noise, xStart, yStart, step, width, height))
+		{
+			clear();
+			seed = noise.GetSeed();
+			frequency = noise.GetFrequency();
+			lacunarity = noise.GetFractalLacunarity();
+			noiseType = noise.GetNoiseType();
+			cellularDistanceFunction = noise.GetCellularDistanceFunction();
+			cellularReturnType = noise.GetCellularReturnType();
+			cellularJitter = noise.GetCellularJitter();
+			this->xStart = xStart;
+			this->yStart = yStart;
+			this->step = step;
+			this->width = width;
+			this->height = height;
+		}
+
+		FastNoiseLite::FractalType fractalType = noise.GetFractalType();
+		bool fractal = fractalType == FastNoiseLite::FractalType_FBm || fractalType == FastNoiseLite::FractalType_Ridged ||
+					   fractalType == FastNoiseLite::FractalType_PingPong;
+		int octaves = fractal ? noise.GetFractalOctaves() : 1;
+
+		// octaves dropped by an earlier, larger count are kept for when it goes back up
+		int computed = 0;
+		while ((int)layers.size() < octaves)
+		{
+			int octave = layers.size();
+			layers.emplace_back(width * height);
+			if (dispatch)
+				dispatch->getNoiseOctaveGrid(noise, octave, xStart, yStart, step, width, height, &layers[octave][0]);
+			else
+			{
+				for (int y = 0; y < height; y++)
+					for (int x = 0; x < width; x++)
+						layers[octave][y * width + x] = noise.GetNoiseOctave(xStart + x * step, yStart + y * step, octave);
+			}
+			computed++;
+		}
+
+		// the same combine as GetNoise, one octave at a time over the whole grid
+		int count = width * height;
+		amps.assign(count, noise.GetFractalBounding());
+		std::fill(out, out + count, 0.0f);
+		for (int octave = 0; octave < octaves; octave++)
+		{
+			const float *layer = &layers[octave][0];
+			for (int i = 0; i < count; i++)
+				noise.AddOctave(layer[i], out[i], amps[i]);
+		}
+
+		return computed;
+	}
+
+	int getLayerCount() const
+	{
+		return layers.size();
+	}
+
+	// drops every stored octave
+	void clear()
+	{
+		layers.clear();
+		noiseType = -1;
+	}
+};
+
+#endif
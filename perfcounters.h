@@ -0,0 +1,185 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+// hardware performance counters of the calling thread through perf_event_open, Linux only.
+// needs kernel.perf_event_paranoid <= 2 (the default on most distributions) and a
+// PMU the kernel exposes, virtual machines often have none
+
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum PerfCounter
+{
+	COUNTER_CYCLES,
+	COUNTER_INSTRUCTIONS,
+	COUNTER_L1D_MISSES,
+	COUNTER_LLC_MISSES,
+	COUNTER_BRANCH_MISSES,
+	COUNTER_COUNT
+};
+
+const char *const PERF_COUNTER_NAMES[COUNTER_COUNT] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+struct PerfSample
+{
+	unsigned long long values[COUNTER_COUNT];
+	// nanoseconds the group was enabled and actually counting, they differ once the
+	// kernel multiplexes it with other events
+	unsigned long long enabled;
+	unsigned long long running;
+};
+
+// one counter group, so all counters run (or are multiplexed out) together
+class PerfCounters
+{
+private:
+	int fds[COUNTER_COUNT] = {-1, -1, -1, -1, -1};
+	int leader = -1;
+
+	// position of each counter in a group read, -1 if the CPU doesn't have it
+	int slots[COUNTER_COUNT] = {-1, -1, -1, -1, -1};
+	int opened = 0;
+
+#ifdef __linux__
+	static void describe(PerfCounter counter, perf_event_attr &attr)
+	{
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+
+		switch (counter)
+		{
+		case COUNTER_CYCLES:
+			attr.config = PERF_COUNT_HW_CPU_CYCLES;
+			break;
+		case COUNTER_INSTRUCTIONS:
+			attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+			break;
+		case COUNTER_L1D_MISSES:
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+			break;
+		case COUNTER_LLC_MISSES:
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			break;
+		default:
+			attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+			break;
+		}
+
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	}
+#endif
+
+public:
+	~PerfCounters()
+	{
+		terminate();
+	}
+
+	// opens every counter the CPU has, returns false if none could be opened
+	bool init()
+	{
+#ifdef __linux__
+		for (int counter = 0; counter < COUNTER_COUNT; counter++)
+		{
+			perf_event_attr attr;
+			describe((PerfCounter)counter, attr);
+			attr.disabled = leader == -1;
+
+			int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+			if (fd == -1)
+			{
+				std::cout << "perf counters: " << PERF_COUNTER_NAMES[counter] << " unavailable, " << strerror(errno) << std::endl;
+				continue;
+			}
+
+			if (leader == -1)
+				leader = fd;
+			fds[counter] = fd;
+			slots[counter] = opened++;
+		}
+
+		if (leader == -1)
+			return false;
+
+		ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		return true;
+#else
+		std::cout << "perf counters: only supported on Linux" << std::endl;
+		return false;
+#endif
+	}
+
+	bool isEnabled() const
+	{
+		return leader != -1;
+	}
+
+	bool has(PerfCounter counter) const
+	{
+		return slots[counter] != -1;
+	}
+
+	// running totals since init(), missing counters read 0
+	void read(PerfSample &sample) const
+	{
+		memset(&sample, 0, sizeof(sample));
+
+#ifdef __linux__
+		// nr, time enabled, time running, then one value per counter in the order they were opened
+		unsigned long long buffer[3 + COUNTER_COUNT];
+		if (::read(leader, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(unsigned long long)))
+			return;
+
+		sample.enabled = buffer[1];
+		sample.running = buffer[2];
+		for (int counter = 0; counter < COUNTER_COUNT; counter++)
+		{
+			if (slots[counter] != -1 && (unsigned long long)slots[counter] < buffer[0])
+				sample.values[counter] = buffer[3 + slots[counter]];
+		}
+#endif
+	}
+
+	// the count between two samples. while the group was multiplexed out it counted
+	// nothing, so the count is scaled up by the share of the time it actually ran
+	static double delta(const PerfSample &start, const PerfSample &end, PerfCounter counter)
+	{
+		double count = (double)(end.values[counter] - start.values[counter]);
+		unsigned long long enabled = end.enabled - start.enabled;
+		unsigned long long running = end.running - start.running;
+		if (running == 0 || running >= enabled)
+			return count;
+		return count * enabled / running;
+	}
+
+	void terminate()
+	{
+#ifdef __linux__
+		for (int &fd : fds)
+		{
+			if (fd != -1)
+				close(fd);
+			fd = -1;
+		}
+#endif
+		leader = -1;
+		opened = 0;
+		for (int &slot : slots)
+			slot = -1;
+	}
+};
+
+#endif
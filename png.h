@@ -0,0 +1,113 @@
+#ifndef PNG_H
+#define PNG_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// minimal RGBA8 PNG writer for frame captures. the image data goes into
+// uncompressed deflate blocks, so no zlib dependency is needed
+namespace Png
+{
+	inline uint32_t crc(const unsigned char *data, size_t length, uint32_t crc = 0xffffffffu)
+	{
+		static uint32_t table[256];
+		static bool tableReady = false;
+		if (!tableReady)
+		{
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				uint32_t c = n;
+				for (int k = 0; k < 8; k++)
+					c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				table[n] = c;
+			}
+			tableReady = true;
+		}
+
+		for (size_t i = 0; i < length; i++)
+			crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+		return crc;
+	}
+
+	inline void putU32(std::vector<unsigned char> &out, uint32_t value)
+	{
+		out.push_back(value >> 24);
+		out.push_back(value >> 16);
+		out.push_back(value >> 8);
+		out.push_back(value);
+	}
+
+	inline void writeChunk(std::ofstream &file, const char *type, const std::vector<unsigned char> &data)
+	{
+		std::vector<unsigned char> chunk;
+		putU32(chunk, data.size());
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		putU32(chunk, crc(&chunk[4], chunk.size() - 4) ^ 0xffffffffu);
+		file.write((const char *)chunk.data(), chunk.size());
+	}
+
+	// rows are top to bottom, 4 bytes per pixel. returns false if the file can't be written
+	inline bool write(const std::string &path, int width, int height, const unsigned char *rgba)
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		const unsigned char signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+		file.write((const char *)signature, sizeof(signature));
+
+		std::vector<unsigned char> header;
+		putU32(header, width);
+		putU32(header, height);
+		header.push_back(8); // bit depth
+		header.push_back(6); // RGBA
+		header.push_back(0);
+		header.push_back(0);
+		header.push_back(0);
+		writeChunk(file, "IHDR", header);
+
+		// every row is prefixed with filter type 0
+		std::vector<unsigned char> raw;
+		raw.reserve((size_t)(width * 4 + 1) * height);
+		for (int y = 0; y < height; y++)
+		{
+			raw.push_back(0);
+			raw.insert(raw.end(), rgba + (size_t)y * width * 4, rgba + (size_t)(y + 1) * width * 4);
+		}
+
+		// zlib stream of stored blocks
+		std::vector<unsigned char> data = {0x78, 0x01};
+		uint32_t a = 1, b = 0;
+		for (size_t offset = 0; offset < raw.size() || offset == 0; offset += 65535)
+		{
+			size_t length = raw.size() - offset < 65535 ? raw.size() - offset : 65535;
+			bool last = offset + length >= raw.size();
+
+			data.push_back(last ? 1 : 0);
+			data.push_back(length & 0xff);
+			data.push_back(length >> 8);
+			data.push_back(~length & 0xff);
+			data.push_back((~length >> 8) & 0xff);
+			data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + length);
+
+			for (size_t i = offset; i < offset + length; i++)
+			{
+				a = (a + raw[i]) % 65521;
+				b = (b + a) % 65521;
+			}
+
+			if (last)
+				break;
+		}
+		putU32(data, (b << 16) | a);
+		writeChunk(file, "IDAT", data);
+
+		writeChunk(file, "IEND", {});
+		return (bool)file;
+	}
+}
+
+#endif
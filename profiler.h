@@ -0,0 +1,408 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "trace.h"
+#include "perfcounters.h"
+#include "memstats.h"
+
+// frames kept for the CSV/JSON dump, about 4s at 60fps
+const int PROFILER_HISTORY = 256;
+
+// GL_TIME_ELAPSED queries in flight, a frame's GPU time is read as soon as it is
+// available, and dropped only if it still isn't when its query comes round again
+const int PROFILER_QUERY_COUNT = 4;
+
+// CPU stages of a frame, in the order render() runs them
+enum ProfileStage
+{
+	STAGE_NOISE,
+	STAGE_INDICES,
+	STAGE_NORMALS,
+	STAGE_UPLOAD,
+	STAGE_DRAW,
+	STAGE_COUNT
+};
+
+const char *const PROFILE_STAGE_NAMES[STAGE_COUNT] = {"noise", "indices", "normals", "upload", "draw"};
+
+// milliseconds, gpu is negative until (or if never) its query result arrives
+struct ProfileFrame
+{
+	long long frame;
+	double stages[STAGE_COUNT];
+	double cpu;
+	double gpu;
+};
+
+// per-stage CPU timers and GPU timer queries for the frame loop. the last
+// PROFILER_HISTORY frames are kept in a ring buffer, the means cover the whole run.
+// with GLTERRAIN_TRACE every frame and stage is also recorded as a trace span,
+// after initCounters() every stage also counts hardware events
+class Profiler
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	ProfileFrame history[PROFILER_HISTORY] = {};
+	long long frameCount = 0;
+
+	Clock::time_point frameStart;
+	Clock::time_point stageStart[STAGE_COUNT];
+
+	double stageTotals[STAGE_COUNT] = {};
+	double cpuTotal = 0.0;
+	double gpuTotal = 0.0;
+	long long gpuCount = 0;
+	long long gpuDropped = 0;
+
+	PerfCounters counters;
+	PerfSample stageCounters[STAGE_COUNT];
+	double counterTotals[STAGE_COUNT][COUNTER_COUNT] = {};
+
+	unsigned int queries[PROFILER_QUERY_COUNT] = {};
+	long long queryFrame[PROFILER_QUERY_COUNT] = {};
+	bool queryPending[PROFILER_QUERY_COUNT] = {};
+
+	static double milliseconds(Clock::time_point start, Clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	ProfileFrame &current()
+	{
+		return history[frameCount % PROFILER_HISTORY];
+	}
+
+	// oldest first
+	const ProfileFrame &recent(int i) const
+	{
+		long long stored = frameCount < PROFILER_HISTORY ? frameCount : PROFILER_HISTORY;
+		return history[(frameCount - stored + i) % PROFILER_HISTORY];
+	}
+
+	int recentCount() const
+	{
+		return frameCount < PROFILER_HISTORY ? (int)frameCount : PROFILER_HISTORY;
+	}
+
+	// never blocks, a result that isn't ready yet stays pending. reusing the slot
+	// drops it, which gpuDropped counts so a biased gpu mean shows in the report
+	void collectQuery(int slot, bool reuse)
+	{
+		if (!queryPending[slot])
+			return;
+
+		int available = 0;
+		glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			if (reuse)
+			{
+				queryPending[slot] = false;
+				gpuDropped++;
+			}
+			return;
+		}
+
+		queryPending[slot] = false;
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+
+		double gpu = nanoseconds / 1e6;
+		gpuTotal += gpu;
+		gpuCount++;
+
+		// the frame may already have left the ring buffer
+		if (frameCount - queryFrame[slot] < PROFILER_HISTORY)
+			history[queryFrame[slot] % PROFILER_HISTORY].gpu = gpu;
+	}
+
+public:
+	void init()
+	{
+		glGenQueries(PROFILER_QUERY_COUNT, queries);
+	}
+
+	// hardware counters per stage, returns false if perf_event_open isn't available
+	bool initCounters()
+	{
+		return counters.init();
+	}
+
+	void beginFrame()
+	{
+		ProfileFrame &frame = current();
+		frame = {};
+		frame.frame = frameCount;
+		frame.gpu = -1.0;
+
+		frameStart = Clock::now();
+	}
+
+	void endFrame()
+	{
+		Clock::time_point now = Clock::now();
+		TRACE_SPAN("frame", frameStart, now);
+
+		double cpu = milliseconds(frameStart, now);
+		current().cpu = cpu;
+		cpuTotal += cpu;
+
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+			stageTotals[stage] += current().stages[stage];
+
+		frameCount++;
+		memoryAccounting().endFrame();
+
+		// results arrive in order, but a late one must not hold up the rest
+		for (int slot = 0; slot < PROFILER_QUERY_COUNT; slot++)
+			collectQuery(slot, false);
+	}
+
+	void begin(ProfileStage stage)
+	{
+		if (counters.isEnabled())
+			counters.read(stageCounters[stage]);
+
+		stageStart[stage] = Clock::now();
+	}
+
+	void end(ProfileStage stage)
+	{
+		Clock::time_point now = Clock::now();
+		TRACE_SPAN(PROFILE_STAGE_NAMES[stage], stageStart[stage], now);
+
+		current().stages[stage] += milliseconds(stageStart[stage], now);
+
+		if (counters.isEnabled())
+		{
+			PerfSample sample;
+			counters.read(sample);
+			for (int counter = 0; counter < COUNTER_COUNT; counter++)
+				counterTotals[stage][counter] += PerfCounters::delta(stageCounters[stage], sample, (PerfCounter)counter);
+		}
+	}
+
+	// GL_TIME_ELAPSED can't nest, so there is one GPU range per frame
+	void beginGpu()
+	{
+		int slot = frameCount % PROFILER_QUERY_COUNT;
+		collectQuery(slot, true);
+
+		glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+		queryFrame[slot] = frameCount;
+	}
+
+	void endGpu()
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		queryPending[frameCount % PROFILER_QUERY_COUNT] = true;
+	}
+
+	long long frames() const
+	{
+		return frameCount;
+	}
+
+	double stageMean(ProfileStage stage) const
+	{
+		return frameCount ? stageTotals[stage] / frameCount : 0.0;
+	}
+
+	double cpuMean() const
+	{
+		return frameCount ? cpuTotal / frameCount : 0.0;
+	}
+
+	double gpuMean() const
+	{
+		return gpuCount ? gpuTotal / gpuCount : 0.0;
+	}
+
+	// frames whose GPU time never arrived, left out of gpuMean()
+	long long gpuDroppedFrames() const
+	{
+		return gpuDropped;
+	}
+
+	bool hasCounters() const
+	{
+		return counters.isEnabled();
+	}
+
+	// events per frame, 0 for counters the CPU doesn't have
+	double counterMean(ProfileStage stage, PerfCounter counter) const
+	{
+		return frameCount ? counterTotals[stage][counter] / frameCount : 0.0;
+	}
+
+	void print() const
+	{
+		std::cout << "profile: " << frameCount << " frames, ms";
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+			std::cout << " " << PROFILE_STAGE_NAMES[stage] << " " << stageMean((ProfileStage)stage);
+		std::cout << " cpu " << cpuMean() << " gpu " << gpuMean() << " (" << gpuDropped << " dropped)" << std::endl;
+		memoryAccounting().print();
+
+		if (!hasCounters())
+			return;
+
+		// per frame means, plus instructions per cycle to tell compute from memory bound stages
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+		{
+			std::cout << "counters " << PROFILE_STAGE_NAMES[stage] << ":";
+			for (int counter = 0; counter < COUNTER_COUNT; counter++)
+			{
+				if (counters.has((PerfCounter)counter))
+					std::cout << " " << PERF_COUNTER_NAMES[counter] << " " << counterMean((ProfileStage)stage, (PerfCounter)counter);
+			}
+
+			double cycles = counterMean((ProfileStage)stage, COUNTER_CYCLES);
+			if (cycles > 0.0)
+				std::cout << " ipc " << counterMean((ProfileStage)stage, COUNTER_INSTRUCTIONS) / cycles;
+			std::cout << std::endl;
+		}
+	}
+
+	// one row per frame in the ring buffer, empty gpu column if the query was dropped
+	bool writeCsv(const std::string &filePath) const
+	{
+		std::ofstream file(filePath);
+		if (!file)
+		{
+			std::cout << "ERROR::PROFILER::CANNOT_WRITE: " << filePath << std::endl;
+			return false;
+		}
+
+		file << "frame";
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+			file << "," << PROFILE_STAGE_NAMES[stage];
+		file << ",cpu,gpu\n";
+
+		for (int i = 0; i < recentCount(); i++)
+		{
+			const ProfileFrame &frame = recent(i);
+			file << frame.frame;
+			for (int stage = 0; stage < STAGE_COUNT; stage++)
+				file << "," << frame.stages[stage];
+			file << "," << frame.cpu << ",";
+			if (frame.gpu >= 0.0)
+				file << frame.gpu;
+			file << "\n";
+		}
+
+		return true;
+	}
+
+	// run means plus the frames in the ring buffer, gpu is null if the query was dropped
+	bool writeJson(const std::string &filePath) const
+	{
+		std::ofstream file(filePath);
+		if (!file)
+		{
+			std::cout << "ERROR::PROFILER::CANNOT_WRITE: " << filePath << std::endl;
+			return false;
+		}
+
+		file.precision(10);
+		file << "{\n\t\"frames\": " << frameCount << ",\n\t\"mean_ms\": {";
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+			file << "\n\t\t\"" << PROFILE_STAGE_NAMES[stage] << "\": " << stageMean((ProfileStage)stage) << ",";
+		file << "\n\t\t\"cpu\": " << cpuMean() << ",\n\t\t\"gpu\": " << gpuMean() << "\n\t},";
+		file << "\n\t\"gpu_dropped\": " << gpuDropped << ",";
+
+		// per frame means of every stage
+		if (hasCounters())
+		{
+			file << "\n\t\"counters\": {";
+			for (int stage = 0; stage < STAGE_COUNT; stage++)
+			{
+				file << (stage ? ",\n" : "\n") << "\t\t\"" << PROFILE_STAGE_NAMES[stage] << "\": {";
+				bool first = true;
+				for (int counter = 0; counter < COUNTER_COUNT; counter++)
+				{
+					if (!counters.has((PerfCounter)counter))
+						continue;
+					file << (first ? "" : ", ") << "\"" << PERF_COUNTER_NAMES[counter] << "\": " << counterMean((ProfileStage)stage, (PerfCounter)counter);
+					first = false;
+				}
+				file << "}";
+			}
+			file << "\n\t},";
+		}
+
+		// bytes in use and the most ever in use, per category
+		const MemoryAccounting &memory = memoryAccounting();
+		file << "\n\t\"memory\": {\n\t\t\"cpu\": {";
+		for (int category = 0; category < MEMORY_CATEGORY_COUNT; category++)
+		{
+			const MemoryCounter &counter = memory.cpuCounter((MemoryCategory)category);
+			file << (category ? ", " : "") << "\"" << MEMORY_CATEGORY_NAMES[category] << "\": {\"current\": " << counter.current
+				 << ", \"peak\": " << counter.peak << ", \"allocations\": " << counter.allocations << "}";
+		}
+		file << "},\n\t\t\"gpu\": {";
+		for (int category = 0; category < GPU_MEMORY_CATEGORY_COUNT; category++)
+		{
+			const MemoryCounter &counter = memory.gpuCounter((GpuMemoryCategory)category);
+			file << (category ? ", " : "") << "\"" << GPU_MEMORY_CATEGORY_NAMES[category] << "\": {\"current\": " << counter.current
+				 << ", \"peak\": " << counter.peak << ", \"allocations\": " << counter.allocations << "}";
+		}
+		file << "},\n\t\t\"allocations_last_frame\": " << memory.allocationsLastFrame()
+			 << ",\n\t\t\"allocations_peak_frame\": " << memory.allocationsPeakFrame() << "\n\t},";
+
+		file << "\n\t\"history\": [";
+
+		for (int i = 0; i < recentCount(); i++)
+		{
+			const ProfileFrame &frame = recent(i);
+			file << (i ? ",\n" : "\n") << "\t\t{\"frame\": " << frame.frame;
+			for (int stage = 0; stage < STAGE_COUNT; stage++)
+				file << ", \"" << PROFILE_STAGE_NAMES[stage] << "\": " << frame.stages[stage];
+			file << ", \"cpu\": " << frame.cpu << ", \"gpu\": ";
+			if (frame.gpu >= 0.0)
+				file << frame.gpu;
+			else
+				file << "null";
+			file << "}";
+		}
+
+		file << "\n\t]\n}\n";
+		return true;
+	}
+
+	// writes name.csv and name.json
+	void dump(const std::string &name) const
+	{
+		if (writeCsv(name + ".csv") && writeJson(name + ".json"))
+			std::cout << "profile: wrote " << name << ".csv and " << name << ".json" << std::endl;
+	}
+};
+
+// times the rest of the enclosing block as one stage
+class ProfileScope
+{
+private:
+	Profiler &profiler;
+	ProfileStage stage;
+
+public:
+	ProfileScope(Profiler &profiler, ProfileStage stage) : profiler(profiler), stage(stage)
+	{
+		profiler.begin(stage);
+	}
+
+	~ProfileScope()
+	{
+		profiler.end(stage);
+	}
+};
+
+#endif
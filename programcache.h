@@ -0,0 +1,138 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// on-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary).
+// entries are keyed by a hash of the shader sources and the driver strings, so
+// editing a shader or updating the driver just misses and relinks from source
+const char *const PROGRAM_CACHE_DIR = "shadercache";
+
+namespace ProgramCache
+{
+	const uint32_t MAGIC = 0x42504c47; // "GLPB"
+
+	struct Header
+	{
+		uint32_t magic;
+		uint64_t key;
+		uint32_t format;
+		uint32_t length;
+	};
+
+	// FNV-1a, stable across runs and platforms
+	inline uint64_t hash(const std::string &data, uint64_t hash = 14695981039346656037ull)
+	{
+		for (unsigned char c : data)
+		{
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	inline std::string glString(GLenum name)
+	{
+		const char *value = (const char *)glGetString(name);
+		return value ? value : "";
+	}
+
+	// needs a current context for the driver strings
+	inline uint64_t key(const std::vector<std::string> &sources)
+	{
+		uint64_t key = hash(glString(GL_VENDOR));
+		key = hash(glString(GL_RENDERER), key);
+		key = hash(glString(GL_VERSION), key);
+		for (const std::string &source : sources)
+			key = hash(source, key);
+		return key;
+	}
+
+	inline bool supported()
+	{
+		if (!GLAD_GL_VERSION_4_1)
+			return false;
+
+		int formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		return formats > 0;
+	}
+
+	inline std::string path(uint64_t key)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+		return std::string(PROGRAM_CACHE_DIR) + "/" + name;
+	}
+
+	// returns true if the program was linked from the cached binary
+	inline bool load(unsigned int program, uint64_t key)
+	{
+		if (!supported())
+			return false;
+
+		std::ifstream file(path(key), std::ios::binary);
+		if (!file)
+			return false;
+
+		Header header;
+		if (!file.read((char *)&header, sizeof(header)) || header.magic != MAGIC || header.key != key)
+			return false;
+
+		std::vector<char> binary(header.length);
+		if (!file.read(binary.data(), header.length))
+			return false;
+
+		glProgramBinary(program, header.format, binary.data(), header.length);
+
+		// the driver may still reject a binary it produced earlier
+		int success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		return success;
+	}
+
+	// call before glLinkProgram so the driver keeps the binary around
+	inline void prepare(unsigned int program)
+	{
+		if (supported())
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	inline void save(unsigned int program, uint64_t key)
+	{
+		if (!supported())
+			return;
+
+		int length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		std::vector<char> binary(length);
+		GLenum format;
+		glGetProgramBinary(program, length, NULL, &format, binary.data());
+
+		std::error_code error;
+		std::filesystem::create_directories(PROGRAM_CACHE_DIR, error);
+
+		std::ofstream file(path(key), std::ios::binary);
+		if (!file)
+		{
+			std::cout << "WARNING::PROGRAM_CACHE::CANNOT_WRITE: " << path(key) << std::endl;
+			return;
+		}
+
+		Header header = {MAGIC, key, format, (uint32_t)length};
+		file.write((const char *)&header, sizeof(header));
+		file.write(binary.data(), length);
+	}
+}
+
+#endif
@@ -9,50 +9,49 @@ in vec3 Position;
 vec3 lightColor = vec3(1.0, 1.0, 1.0);
 float ambientStrength = 0.1;
 
-uniform vec3 lightPosition;
-uniform bool showNormals;
+// per-frame data shared by all terrain shaders, see framedata.h
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 lightPosition;
+	int debugFlags; // ShaderFeature bits of the active variant
+};
 
 float constant = 1.0;
 float linear = 0.014;
 float quadratic = 0.0007;
 
-// MAKE THESE ENUMS AND UNIFORMS LATER 
+// lines drawn by the WIREFRAME variant
+vec3 wireframeColor = vec3(0.1, 0.1, 0.1);
+
+uniform sampler1D materialRamp;
+// heights mapped to the first and last texel of materialRamp
+uniform vec2 materialRange;
+
+// variants: DEBUG_NORMALS, WIREFRAME, UNLIT, see shadervariants.h
 void main()
 {
-	vec3 objectColor;
-
+#if defined(DEBUG_NORMALS)
+	fragColor = vec4(Normal, 1.0);
+#elif defined(WIREFRAME)
+	fragColor = vec4(wireframeColor, 1.0);
+#else
 	vec3 ambient = ambientStrength * lightColor;
 
-	if (height > 45)
-	{
-		objectColor = vec3(1.0f, 1.0f, 1.0f);
-	}
-	else if (height > 20)
-	{
-		objectColor = vec3(91.0f/255.0f, 91.0f/255.0f, 91.0f/255.0f);
-	}
-	else if (height > 10)
-	{
-		// fragColor = vec4(0.34f, 0.49f, 0.27f, 1.0f);
-		objectColor = vec3(0.76f, 0.70f, 0.50f);
-		
-	}
-	else if (height > 0)
-	{
-		objectColor = vec3(0.76f, 0.70f, 0.50f);
-	}
-	else
-	{
-		objectColor = vec3(14.0/255.0, 131.0/255.0, 198.0 / 255.0);
-	}
+	// height -> color ramp baked from the material table, see materials.h
+	vec3 objectColor = texture(materialRamp, (height - materialRange.x) / (materialRange.y - materialRange.x)).rgb;
 
-	vec3 lightRay = normalize(lightPosition - Position);
+#ifdef UNLIT
+	fragColor = vec4(objectColor, 1.0);
+#else
+	vec3 lightRay = normalize(lightPosition.xyz - Position);
 	float diffuseStrength = max(dot(lightRay, Normal), 0.0);
 
 	vec3 diffuse = diffuseStrength * lightColor;
 
 // TEST
-	float distance = length(lightPosition - Position);
+	float distance = length(lightPosition.xyz - Position);
 	float attenuation = 1.0 / (constant + linear * distance + 
     		    quadratic * (distance * distance));   
 	ambient *= attenuation;
@@ -60,15 +59,7 @@ void main()
 // TEST
 	vec3 finalColor = (ambient + diffuse) * objectColor;
 
-	if (showNormals)
-	{
-		fragColor = vec4(Normal, 1.0);
-	}
-	else
-	{
-		fragColor = vec4(finalColor, 1.0);
-
-	}
-
-
+	fragColor = vec4(finalColor, 1.0);
+#endif
+#endif
 }
\ No newline at end of file
@@ -10,21 +10,149 @@
 #include <sstream>
 #include <iostream>
 #include <string.h>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "programcache.h"
+
 class Shader
 {
 public:
 	unsigned int ID;
-	// constructor generates the shader on the fly
+	// constructor only records the paths, the files are read in compile().
+	// defines are injected into both stages right after the #version line
 	// ------------------------------------------------------------------------
-	Shader(const char *vertexPath, const char *fragmentPath)
+	Shader(const char *vertexPath, const char *fragmentPath, const std::vector<std::string> &defines = {})
+		: vertexPath(vertexPath), fragmentPath(fragmentPath), defines(defines)
 	{
+	}
+
+	void compile()
+	{
+		auto start = std::chrono::steady_clock::now();
+
 		// 1. retrieve the vertex/fragment source code from filePath
-		std::string vertexCode;
-		std::string fragmentCode;
+		load();
+
+		// 2. reuse the linked binary from an earlier run when nothing changed
+		ID = glCreateProgram();
+		uint64_t cacheKey = ProgramCache::key({vertexCode, fragmentCode});
+		bool cached = ProgramCache::load(ID, cacheKey);
+
+		if (!cached)
+		{
+			glDeleteProgram(ID);
+			link();
+			ProgramCache::save(ID, cacheKey);
+		}
+		cacheUniformLocations();
+
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "shader " << vertexPath << " + " << fragmentPath;
+		for (const std::string &define : defines)
+			std::cout << " " << define;
+		std::cout << ": " << (cached ? "program cache hit" : "compiled from source") << " in " << elapsed << " ms" << std::endl;
+	}
+	// activate the shader
+	// ------------------------------------------------------------------------
+	void use()
+	{
+		glUseProgram(ID);
+	}
+	// attach a named uniform block to a GL_UNIFORM_BUFFER binding point
+	// ------------------------------------------------------------------------
+	void bindUniformBlock(const char *name, unsigned int binding) const
+	{
+		unsigned int index = glGetUniformBlockIndex(ID, name);
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(ID, index, binding);
+	}
+	// location cached at link time, -1 if the uniform is unused. keep the
+	// result for uniforms set every frame to skip the name lookup entirely
+	// ------------------------------------------------------------------------
+	int getUniformLocation(const std::string &name) const
+	{
+		auto it = uniformLocations.find(name);
+		return it != uniformLocations.end() ? it->second : -1;
+	}
+	// utility uniform functions
+	// ------------------------------------------------------------------------
+	void setBool(const std::string &name, bool value) const
+	{
+		setBool(getUniformLocation(name), value);
+	}
+	// ------------------------------------------------------------------------
+	void setInt(const std::string &name, int value) const
+	{
+		setInt(getUniformLocation(name), value);
+	}
+	// ------------------------------------------------------------------------
+	void setFloat(const std::string &name, float value) const
+	{
+		setFloat(getUniformLocation(name), value);
+	}
+
+	void setVec2(const std::string &name, glm::vec2 vec) const
+	{
+		setVec2(getUniformLocation(name), vec);
+	}
+
+	void setVec3(const std::string &name, glm::vec3 &vec) const
+	{
+		setVec3(getUniformLocation(name), vec);
+	}
+
+	void setMat4(const std::string &name, glm::mat4 &mat) const
+	{
+		setMat4(getUniformLocation(name), mat);
+	}
+	// same, with a location from getUniformLocation()
+	// ------------------------------------------------------------------------
+	void setBool(int location, bool value) const
+	{
+		glUniform1i(location, (int)value);
+	}
+
+	void setInt(int location, int value) const
+	{
+		glUniform1i(location, value);
+	}
+
+	void setFloat(int location, float value) const
+	{
+		glUniform1f(location, value);
+	}
+
+	void setVec2(int location, glm::vec2 vec) const
+	{
+		glUniform2f(location, vec.x, vec.y);
+	}
+
+	void setVec3(int location, glm::vec3 &vec) const
+	{
+		glUniform3fv(location, 1, glm::value_ptr(vec));
+	}
+
+	void setMat4(int location, glm::mat4 &mat) const
+	{
+		glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+	}
+
+private:
+	std::string vertexPath;
+	std::string fragmentPath;
+	std::vector<std::string> defines;
+	std::string vertexCode;
+	std::string fragmentCode;
+
+	std::unordered_map<std::string, int> uniformLocations;
+
+	void load()
+	{
 		std::ifstream vShaderFile;
 		std::ifstream fShaderFile;
 		// ensure ifstream objects can throw exceptions:
@@ -44,20 +172,39 @@ public:
 			vShaderFile.close();
 			fShaderFile.close();
 			// convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
+			vertexCode = injectDefines(vShaderStream.str());
+			fragmentCode = injectDefines(fShaderStream.str());
 		}
 		catch (std::ifstream::failure &e)
 		{
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
 		}
-		vShaderCode = strdup(vertexCode.c_str());
-		fShaderCode = strdup(fragmentCode.c_str());
 	}
 
-	void compile()
+	// #version has to stay the first line
+	std::string injectDefines(const std::string &code) const
 	{
-		// 2. compile shaders
+		if (defines.empty())
+			return code;
+
+		std::string block;
+		for (const std::string &define : defines)
+			block += "#define " + define + "\n";
+
+		if (code.compare(0, 8, "#version") != 0)
+			return block + code;
+
+		size_t lineEnd = code.find('\n');
+		if (lineEnd == std::string::npos)
+			return code + "\n" + block;
+
+		return code.substr(0, lineEnd + 1) + block + code.substr(lineEnd + 1);
+	}
+
+	void link()
+	{
+		const char *vShaderCode = vertexCode.c_str();
+		const char *fShaderCode = fragmentCode.c_str();
 		unsigned int vertex, fragment;
 		// vertex shader
 		vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -73,50 +220,43 @@ public:
 		ID = glCreateProgram();
 		glAttachShader(ID, vertex);
 		glAttachShader(ID, fragment);
+		ProgramCache::prepare(ID);
 		glLinkProgram(ID);
 		checkCompileErrors(ID, "PROGRAM");
 		// delete the shaders as they're linked into our program now and no longer necessary
 		glDeleteShader(vertex);
 		glDeleteShader(fragment);
 	}
-	// activate the shader
-	// ------------------------------------------------------------------------
-	void use()
-	{
-		glUseProgram(ID);
-	}
-	// utility uniform functions
-	// ------------------------------------------------------------------------
-	void setBool(const std::string &name, bool value) const
-	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-	}
+	// query every active uniform once after linking
 	// ------------------------------------------------------------------------
-	void setInt(const std::string &name, int value) const
+	void cacheUniformLocations()
 	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-	}
-	// ------------------------------------------------------------------------
-	void setFloat(const std::string &name, float value) const
-	{
-		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
-	}
+		uniformLocations.clear();
 
-	void setVec3(const std::string &name, glm::vec3 &vec) const
-	{
-		glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(vec));
-	}
+		int count = 0;
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
 
-	void setMat4(const std::string &name, glm::mat4 &mat) const
-	{
-		glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
-	}
+		for (int i = 0; i < count; i++)
+		{
+			char name[256];
+			int length, size;
+			unsigned int type;
+			glGetActiveUniform(ID, i, sizeof(name), &length, &size, &type, name);
 
-private:
+			// block members have no location
+			int location = glGetUniformLocation(ID, name);
+			if (location < 0)
+				continue;
+
+			// arrays are reported as "name[0]", also accept plain "name"
+			std::string uniformName(name, length);
+			uniformLocations[uniformName] = location;
+			if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+				uniformLocations[uniformName.substr(0, uniformName.size() - 3)] = location;
+		}
+	}
 	// utility function for checking shader compilation/linking errors.
 	// ------------------------------------------------------------------------
-	const char *vShaderCode;
-	const char *fShaderCode;
 	void checkCompileErrors(unsigned int shader, std::string type)
 	{
 		int success;
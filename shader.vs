@@ -7,16 +7,25 @@ out vec3 Normal;
 out vec3 Position;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-frame data shared by all terrain shaders, see framedata.h
+layout (std140) uniform FrameData
+{
+	mat4 view;
+	mat4 projection;
+	vec4 lightPosition;
+	int debugFlags; // ShaderFeature bits of the active variant
+};
 
 out float height;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPosition, 1.0f);
-	height = aPosition.y;
+	vec3 position = aPosition;
+
+	gl_Position = projection * view * model * vec4(position, 1.0f);
+	height = position.y;
 
-	Position = aPosition;
+	Position = position;
 	Normal = normalize(aNormal);
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <string>
+#include <vector>
+
+#include "shader.h"
+
+// feature bits, each one compiles in the matching #define of shader.vs/shader.fs
+enum ShaderFeature
+{
+	SHADER_DEBUG_NORMALS = 1 << 0,
+	SHADER_WIREFRAME = 1 << 1,
+	SHADER_UNLIT = 1 << 2
+};
+
+const int SHADER_FEATURE_COUNT = 3;
+const char *const SHADER_FEATURE_DEFINES[SHADER_FEATURE_COUNT] = {"DEBUG_NORMALS", "WIREFRAME", "UNLIT"};
+
+// one program per feature combination, so no shader branches on debug state at runtime
+class ShaderVariants
+{
+private:
+	std::vector<Shader> variants;
+
+public:
+	ShaderVariants(const char *vertexPath, const char *fragmentPath)
+	{
+		for (unsigned int features = 0; features < (1u << SHADER_FEATURE_COUNT); features++)
+		{
+			std::vector<std::string> defines;
+			for (int i = 0; i < SHADER_FEATURE_COUNT; i++)
+			{
+				if (features & (1u << i))
+					defines.push_back(SHADER_FEATURE_DEFINES[i]);
+			}
+			variants.emplace_back(vertexPath, fragmentPath, defines);
+		}
+	}
+
+	// builds every permutation up front so switching never compiles mid-frame
+	void compileAll()
+	{
+		for (Shader &variant : variants)
+			variant.compile();
+	}
+
+	int count() const
+	{
+		return variants.size();
+	}
+
+	Shader &get(unsigned int features)
+	{
+		return variants[features];
+	}
+
+	Shader &use(unsigned int features)
+	{
+		Shader &variant = variants[features];
+		variant.use();
+		return variant;
+	}
+};
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// span recording exported as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+// opt-in: build with -DGLTERRAIN_TRACE, otherwise the TRACE_ macros compile to nothing
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef GLTERRAIN_TRACE
+const bool TRACE_ENABLED = true;
+#else
+const bool TRACE_ENABLED = false;
+#endif
+
+// spans kept per thread, later ones are counted as dropped
+const int TRACE_BUFFER_EVENTS = 1 << 16;
+
+// steady_clock nanoseconds
+struct TraceEvent
+{
+	const char *name; // must outlive the trace, string literals in practice
+	uint64_t start;
+	uint64_t duration;
+};
+
+// spans of one thread. only the owning thread writes to it, count publishes
+// finished events to the exporter so recording never takes a lock
+struct TraceBuffer
+{
+	TraceEvent events[TRACE_BUFFER_EVENTS];
+	std::atomic<int> count{0};
+	std::atomic<int> dropped{0};
+
+	int thread = 0;
+	const char *name = nullptr;
+	TraceBuffer *next = nullptr;
+};
+
+namespace Trace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	inline uint64_t toNanoseconds(Clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	}
+
+	inline uint64_t now()
+	{
+		return toNanoseconds(Clock::now());
+	}
+
+	// every thread that ever recorded, newest first
+	inline std::atomic<TraceBuffer *> &buffers()
+	{
+		static std::atomic<TraceBuffer *> head{nullptr};
+		return head;
+	}
+
+	// buffers are never freed, so a thread may exit before the trace is written
+	inline TraceBuffer *registerThread()
+	{
+		static std::atomic<int> threads{0};
+
+		TraceBuffer *buffer = new TraceBuffer();
+		buffer->thread = threads++;
+		buffer->next = buffers().load();
+		while (!buffers().compare_exchange_weak(buffer->next, buffer))
+			;
+		return buffer;
+	}
+
+	inline TraceBuffer &threadBuffer()
+	{
+		thread_local TraceBuffer *buffer = registerThread();
+		return *buffer;
+	}
+
+	inline void setThreadName(const char *name)
+	{
+		threadBuffer().name = name;
+	}
+
+	inline void record(const char *name, uint64_t start, uint64_t end)
+	{
+		TraceBuffer &buffer = threadBuffer();
+
+		int index = buffer.count.load(std::memory_order_relaxed);
+		if (index >= TRACE_BUFFER_EVENTS)
+		{
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		buffer.events[index] = {name, start, end - start};
+		buffer.count.store(index + 1, std::memory_order_release);
+	}
+
+	// safe while other threads keep recording, their newer spans are just left out
+	inline bool write(const std::string &filePath)
+	{
+		std::ofstream file(filePath);
+		if (!file)
+		{
+			std::cout << "ERROR::TRACE::CANNOT_WRITE: " << filePath << std::endl;
+			return false;
+		}
+
+		// trace-event timestamps are microseconds, 3 decimals keep the nanoseconds
+		char number[32];
+		auto microseconds = [&](uint64_t nanoseconds) -> const char * {
+			snprintf(number, sizeof(number), "%llu.%03llu", (unsigned long long)(nanoseconds / 1000), (unsigned long long)(nanoseconds % 1000));
+			return number;
+		};
+
+		int spans = 0;
+		int dropped = 0;
+		bool first = true;
+
+		file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+		for (TraceBuffer *buffer = buffers().load(); buffer; buffer = buffer->next)
+		{
+			std::string name = buffer->name ? buffer->name : "thread " + std::to_string(buffer->thread);
+			file << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->thread
+				 << ", \"args\": {\"name\": \"" << name << "\"}}";
+			first = false;
+
+			int count = buffer->count.load(std::memory_order_acquire);
+			for (int i = 0; i < count; i++)
+			{
+				const TraceEvent &event = buffer->events[i];
+				file << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->thread;
+				file << ", \"ts\": " << microseconds(event.start);
+				file << ", \"dur\": " << microseconds(event.duration) << "}";
+			}
+
+			spans += count;
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
+		}
+		file << "\n]}\n";
+
+		std::cout << "trace: wrote " << spans << " spans to " << filePath;
+		if (dropped)
+			std::cout << ", dropped " << dropped << " (buffers full)";
+		std::cout << std::endl;
+		return true;
+	}
+}
+
+// records the enclosing block as one span
+class TraceScope
+{
+private:
+	const char *name;
+	uint64_t start;
+
+public:
+	TraceScope(const char *name) : name(name), start(Trace::now()) {}
+
+	~TraceScope()
+	{
+		Trace::record(name, start, Trace::now());
+	}
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef GLTERRAIN_TRACE
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_SPAN(name, start, end) Trace::record(name, Trace::toNanoseconds(start), Trace::toNanoseconds(end))
+#define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SPAN(name, start, end)
+#define TRACE_THREAD_NAME(name)
+#endif
+
+#endif